@@ -0,0 +1,286 @@
+/*
+    Conway's Game of Life Replica - adaptive stepping
+    One tiled universe, stepped whichever way suits it right now:
+        *  dense   temporal blocks over every tile, for busy boards
+        *  sparse  active tiles only, over the task pool, for quiet ones
+        *  memo    active tiles MEMO_GENS generations a lookup, for
+                   quiet ones made of structure that keeps coming back
+        *  cycle   once the board is known to repeat with period P,
+                   N generations cost N mod P
+    Every ADAPT_SAMPLE generations one generation is stepped sparse,
+    which leaves the changed tiles behind, and the controller measures
+    the fraction of tiles that changed, the population density and a
+    hash of the board. A hash seen again L generations later is checked
+    against a snapshot after another L before the cycle is trusted.
+
+    The population and the hash are running totals over per-tile counts
+    and hashes, and stepping sparse notes the tiles it changed, so a
+    sample costs the active tiles rather than the universe. Only after
+    dense stretches, which touch every tile anyway, is every tile
+    counted again.
+
+    Only a board that repeats as a whole reaches cycle mode. One that is
+    mostly periodic, say a gun and the debris it left behind, never does,
+    since its gliders keep every hash new; memo mode is for that one.
+    Every so often memo gets a few stretches in place of dense or
+    sparse, and keeps them while most of its lookups hit; each time it
+    fails the wait before the next try doubles.
+
+    All four modes share the tiled planes, so switching costs nothing.
+*/
+#ifndef ADAPT_H
+#define ADAPT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memo.h"
+#include "tiles.h"
+
+#define ADAPT_SAMPLE 16     //generations between measurements
+#define ADAPT_HISTORY 64    //hashes kept, so periods up to this many samples
+#define ADAPT_BUSY 0.4      //changed tile fraction that always wants dense
+#define ADAPT_QUIET 0.2     //and below which sparse is cheaper
+#define ADAPT_DENSE 0.1     //population density that tips the middle to dense
+#define ADAPT_HITS 0.6      //fraction of lookups that must hit to stay memo
+#define ADAPT_TRIAL 2       //samples memo gets to fill its table before that
+#define ADAPT_RETRY 16      //samples before memo is tried again, doubling
+#define ADAPT_RETRY_MAX 512 //up to this many
+enum { ADAPT_DENSE_MODE, ADAPT_SPARSE_MODE, ADAPT_MEMO_MODE, ADAPT_CYCLE_MODE };
+static const char* const ADAPT_MODE[] = { "dense", "sparse", "memo", "cycle" };
+
+struct adapt
+{
+    struct tiled t;
+    struct pool* pool;
+    int mode;
+    int plain;              //dense or sparse, what memo would otherwise be
+    uint64_t gen;           //generations since load
+    //measurements at the last sample
+    double changed;         //fraction of tiles
+    double density;
+    //running population and hash, over per-tile counts and hashes
+    uint64_t population;
+    uint64_t sum;
+    uint16_t* pop;
+    uint64_t* tileHash;
+    //tiles changed since the last sample, unless all may have
+    unsigned char* touched;
+    uint32_t* list;
+    uint32_t nlist;
+    int all;
+    //hashes of the last samples, newest at hash[(n-1) % ADAPT_HISTORY]
+    uint64_t hash[ADAPT_HISTORY];
+    uint64_t n;
+    //cycle found by hash, being confirmed against snap
+    uint64_t* snap;
+    uint64_t verify;        //generation to compare at, 0 for none
+    uint64_t lag;
+    uint64_t period;        //confirmed, 0 for none
+    //tile results for memo mode, and how its lookups have been doing
+    struct memo memo;
+    uint64_t hits, misses;  //lookups up to the last sample
+    double hitRate;         //of the ones in the stretch before it
+    uint64_t trial;         //samples left before the hit rate counts
+    uint64_t retry;         //sample from which memo may be tried again
+    uint64_t backoff;       //samples to wait after the next failure
+    uint64_t ran[4];        //generations stepped per mode
+};
+
+//bring tile id's share of the running population and hash up to date
+static inline void adaptTally(struct adapt* a, uint32_t id) {
+    const uint64_t* p = tiledTile(&a->t, a->t.p, id % a->t.tw, id / a->t.tw);
+    uint64_t h = 0x9E3779B97F4A7C15ull, n = 0;
+    int y;
+
+    for (y = 0; y < TILE; ++y) {
+        n += __builtin_popcountll(p[y]);
+        h = (h ^ p[y]) * 0xBF58476D1CE4E5B9ull;
+    }
+    //empty tiles hash to 0, so a board is its live tiles whatever came before
+    h ^= id;
+    h = n ? h ^ (h >> 31) : 0;
+    a->population += n - a->pop[id];
+    a->sum ^= a->tileHash[id] ^ h;
+    a->pop[id] = (uint16_t)n;
+    a->tileHash[id] = h;
+}
+//note the tiles the last tiledStepActive or memoStep changed
+static inline void adaptTouched(struct adapt* a) {
+    uint32_t i, id;
+
+    if (a->all)
+        return;
+    for (i = 0; i < a->t.nactive; ++i) {
+        id = a->t.active[i];
+        if (a->t.changed[id] && !a->touched[id]) {
+            a->touched[id] = 1;
+            a->list[a->nlist++] = id;
+        }
+    }
+}
+
+static inline int adapt_init(struct adapt* a, int w, int h, int depth, struct pool* pool, struct arena* arena) {
+    memset(a, 0, sizeof(*a));
+    if (tiled_init(&a->t, w, h, arena) != 0)
+        return -1;
+    a->t.k = depth;
+    a->pool = pool;
+    a->snap = arenaAlloc(arena, a->t.tw*a->t.th*TILE_BYTES);
+    a->pop = arenaAlloc(arena, a->t.tw*a->t.th*sizeof(uint16_t));
+    a->tileHash = arenaAlloc(arena, a->t.tw*a->t.th*sizeof(uint64_t));
+    a->touched = arenaAlloc(arena, a->t.tw*a->t.th);
+    a->list = arenaAlloc(arena, a->t.tw*a->t.th*sizeof(uint32_t));
+    a->all = 1;
+    a->retry = ADAPT_RETRY;
+    a->backoff = ADAPT_RETRY;
+    if (memo_init(&a->memo, &a->t, pool->threads, arena) != 0)
+        return -1;
+    return (a->snap && a->pop && a->tileHash && a->touched && a->list) ? 0 : -1;
+}
+
+//forget everything measured; the board was changed from outside
+static inline void adaptReset(struct adapt* a) {
+    a->mode = ADAPT_DENSE_MODE;
+    a->plain = ADAPT_DENSE_MODE;
+    a->gen = 0;
+    a->n = 0;
+    a->verify = 0;
+    a->period = 0;
+    a->all = 1;
+    //what the table holds is still good, only the timing starts over
+    a->trial = 0;
+    a->retry = ADAPT_RETRY;
+    a->backoff = ADAPT_RETRY;
+}
+
+//whether the next stretch goes memo: while most of its lookups hit, and
+//after longer and longer waits while they don't
+static inline int adaptMemo(struct adapt* a) {
+    if (a->mode != ADAPT_MEMO_MODE) {
+        if (a->n < a->retry)
+            return 0;
+        a->trial = ADAPT_TRIAL;
+        return 1;
+    }
+    //the first stretches fill the table, so they don't count
+    if (a->trial > 0 && --a->trial > 0)
+        return 1;
+    if (a->hitRate >= ADAPT_HITS) {
+        a->backoff = ADAPT_RETRY;
+        return 1;
+    }
+    a->retry = a->n + a->backoff;
+    a->backoff = a->backoff*2 < ADAPT_RETRY_MAX ? a->backoff*2 : ADAPT_RETRY_MAX;
+    return 0;
+}
+
+//one measured generation, and the mode for the next stretch
+static inline void adaptSample(struct adapt* a) {
+    uint64_t tiles = a->t.tw*a->t.th, changed = 0, h, k, hits, misses;
+    uint32_t i;
+
+    a->t.pool = a->pool;
+    tiledStepActive(&a->t, 1);
+    ++a->gen;
+    ++a->ran[ADAPT_SPARSE_MODE];
+    adaptTouched(a);
+    //only active tiles can have changed
+    for (i = 0; i < a->t.nactive; ++i)
+        changed += a->t.changed[a->t.active[i]];
+    if (a->all) {
+        for (i = 0; i < tiles; ++i)
+            adaptTally(a, i);
+        memset(a->touched, 0, tiles);
+    }
+    else {
+        for (i = 0; i < a->nlist; ++i) {
+            adaptTally(a, a->list[i]);
+            a->touched[a->list[i]] = 0;
+        }
+    }
+    a->nlist = 0;
+    a->all = 0;
+    a->changed = (double)changed/tiles;
+    a->density = (double)a->population/((double)a->t.w*a->t.h);
+    h = a->sum;
+    //the hit rate of the lookups since the last sample, if there were any
+    memoCount(&a->memo, &hits, &misses);
+    if (hits + misses > a->hits + a->misses)
+        a->hitRate = (double)(hits - a->hits)/(hits + misses - a->hits - a->misses);
+    a->hits = hits;
+    a->misses = misses;
+
+    //a suspected cycle is confirmed or dropped once it has come round again
+    if (a->verify == a->gen) {
+        if (!memcmp(a->snap, a->t.plane[a->t.p], tiles*TILE_BYTES))
+            a->period = a->lag;
+        a->verify = 0;
+    }
+    //look for this board among the last samples
+    for (k = 1; !a->period && !a->verify && k <= ADAPT_HISTORY && k <= a->n; ++k) {
+        if (a->hash[(a->n - k) % ADAPT_HISTORY] == h) {
+            memcpy(a->snap, a->t.plane[a->t.p], tiles*TILE_BYTES);
+            a->lag = k*ADAPT_SAMPLE;
+            a->verify = a->gen + a->lag;
+        }
+    }
+    a->hash[a->n++ % ADAPT_HISTORY] = h;
+
+    if (a->changed >= ADAPT_BUSY || (a->changed >= ADAPT_QUIET && a->density >= ADAPT_DENSE))
+        a->plain = ADAPT_DENSE_MODE;
+    else if (a->changed < ADAPT_QUIET)
+        a->plain = ADAPT_SPARSE_MODE;
+    if (a->period)
+        a->mode = ADAPT_CYCLE_MODE;
+    else
+        a->mode = adaptMemo(a) ? ADAPT_MEMO_MODE : a->plain;
+}
+
+static inline void adaptStep(struct adapt* a, uint64_t gens) {
+    uint64_t n, k;
+
+    while (gens > 0) {
+        if (a->mode == ADAPT_CYCLE_MODE) {
+            //the rest is whole laps and a remainder
+            n = gens % a->period;
+            a->t.pool = a->pool;
+            tiledStepActive(&a->t, n);
+            a->all = 1;
+            a->ran[ADAPT_CYCLE_MODE] += gens;
+            a->gen += gens;
+            return;
+        }
+        //samples land on multiples of ADAPT_SAMPLE so cycles are whole numbers of them
+        if (a->gen % ADAPT_SAMPLE == ADAPT_SAMPLE-1) {
+            adaptSample(a);
+            --gens;
+            continue;
+        }
+        n = ADAPT_SAMPLE-1 - a->gen % ADAPT_SAMPLE;
+        if (n > gens)
+            n = gens;
+        if (a->mode != ADAPT_DENSE_MODE) {
+            a->t.pool = a->pool;
+            //memo takes whole lookups, and the rest goes a generation at a time
+            for (k = 0; a->mode == ADAPT_MEMO_MODE && k + MEMO_GENS <= n; k += MEMO_GENS) {
+                memoStep(&a->memo, 1);
+                adaptTouched(a);
+            }
+            for (; k < n; ++k) {
+                tiledStepActive(&a->t, 1);
+                adaptTouched(a);
+            }
+        }
+        else {
+            a->t.pool = NULL;
+            tiledStep(&a->t, n);
+            a->all = 1;
+        }
+        a->ran[a->mode] += n;
+        a->gen += n;
+        gens -= n;
+    }
+}
+
+#endif
@@ -0,0 +1,79 @@
+/*
+    Conway's Game of Life Replica - storage arena
+    Every buffer that scales with the universe is carved out of one
+    anonymous mapping: reserved up front, handed out 64 bytes aligned so
+    rows and tiles start on cache lines, and only backed by memory as it
+    is touched. Nothing is given back until the whole arena goes, and
+    nothing is allocated once stepping starts.
+
+    Asked for huge pages, the arena first tries MAP_HUGETLB and falls
+    back to transparent huge pages through madvise. Huge pages are taken
+    from the reserved pool up front, since a fault past its end would be
+    SIGBUS rather than an error.
+*/
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/mman.h>
+
+#define ARENA_ALIGN 64
+#define ARENA_HUGE (2u << 20)   //huge page size assumed for MAP_HUGETLB
+
+struct arena
+{
+    unsigned char* base;
+    size_t size;            //bytes reserved
+    size_t used;
+    int huge;               //0 none, 1 transparent, 2 hugetlbfs
+};
+
+//reserve size bytes; 0 on success
+static inline int arena_init(struct arena* a, size_t size, int huge) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE;
+    void* p = MAP_FAILED;
+
+    a->used = 0;
+    a->huge = 0;
+#ifdef MAP_HUGETLB
+    if (huge) {
+        a->size = (size + ARENA_HUGE-1) & ~(size_t)(ARENA_HUGE-1);
+        p = mmap(NULL, a->size, PROT_READ | PROT_WRITE, (flags & ~MAP_NORESERVE) | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED)
+            a->huge = 2;
+    }
+#endif
+    if (p == MAP_FAILED) {
+        a->size = size;
+        p = mmap(NULL, a->size, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p == MAP_FAILED) {
+            a->base = NULL;
+            return -1;
+        }
+#ifdef MADV_HUGEPAGE
+        if (huge && madvise(p, a->size, MADV_HUGEPAGE) == 0)
+            a->huge = 1;
+#endif
+    }
+    a->base = p;
+    return 0;
+}
+static inline void arena_free(struct arena* a) {
+    if (a->base)
+        munmap(a->base, a->size);
+    a->base = NULL;
+    a->size = a->used = 0;
+}
+
+//n zeroed bytes, ARENA_ALIGN aligned, or NULL once the reservation is spent
+static inline void* arenaAlloc(struct arena* a, size_t n) {
+    size_t at = (a->used + ARENA_ALIGN-1) & ~(size_t)(ARENA_ALIGN-1);
+
+    if (!a->base || at > a->size || n > a->size - at)
+        return NULL;
+    a->used = at + n;
+    return a->base + at;
+}
+
+#endif
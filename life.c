@@ -27,82 +27,340 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/stat.h>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include "ring.h"
+#include "record.h"
+#include "tiles.h"
+#include "lut.h"
+#include "adapt.h"
+#include "arena.h"
 
 const int WIN_WIDTH = 1600;
 const int WIN_HEIGHT = 900;
 const char* FONT = "../Basic-Regular.ttf";
+const char* FONT_FILE = "Basic-Regular.ttf";
 const int FONT_SIZE = 32;
+const int ATLAS_WIDTH = 1024;
+const char ATLAS_FIRST = ' ';
+//printable ASCII
+#define ATLAS_GLYPHS 95
 const char LIVE = '#';
 const char DEAD = '-';
 const int PX_SIZE = 6;
 const int BUTTON_SIZE = 32;
 const int GENERATORS = 25;
+const double WARP_FPS = 30.0;
+const int WARP_MAX = 65536;
+const double SOUP_DENSITY = 0.35;
+//sparsest soup both fills can tell from empty
+#define SOUP_MIN (1.0/TILE_SOUP_ONE)
+//stamps are at most this many cells on a side, one Uint64 per column
+#define STAMP_MAX 64
+enum { STAMP_OR, STAMP_XOR };
+//grid edits held between generations before they're applied anyway
+#define EDIT_MAX 4096
+//square universe sizes the classic engine has its own unrolled copy for
+#define GRID_SIZES(X) X(256) X(512) X(1024) X(2048) X(4096) X(8192) X(16384) X(32768) X(65536)
+//largest universe side held in memory; bigger wants --tiles
+#define GRID_MAX 65536
 struct px
 {
     SDL_Rect loc;
     SDL_Color col;
     int age;
 };
+struct stamp
+{
+    int w, h;
+    Uint64 col[STAMP_MAX];  //bit y of col[x] set when (x, y) is LIVE
+};
+struct edit
+{
+    int x, y;
+    int mode;
+};
+struct edits
+{
+    const struct stamp* stamp;  //every pending edit blits this
+    int n;
+    struct edit e[EDIT_MAX];
+};
+struct engine
+{
+    const char* name;
+    void* state;
+    //load from the char grid after it was edited, and store to it after stepping; NULL when stepping it directly
+    void (*load)(void* state, int w, int h, char c[w][h]);
+    //returns the grid, which may be another plane than c
+    void* (*step)(void* state, int w, int h, char c[w][h], int gens);
+    void (*store)(void* state, int w, int h, char c[w][h]);
+    //births and deaths of the generation a one-generation step just made, as
+    //fn(arg, x, y, born, died) with bit i for cell (x+i, y)
+    void (*changes)(void* state, int w, int h, char c[w][h], void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg);
+};
+struct classic
+{
+    int* n;                 //neighbour counts
+    char* spare;            //char plane the next generation is written to, then swapped in
+    uint64_t* row;          //births then deaths per row, for a run of 64 columns
+};
+struct lutcopy
+{
+    struct lut* l;
+    char* c;                //the char grid runs are stored to
+};
+struct tilecopy
+{
+    struct tiled* t;
+    int h;
+    char* c;                //the char grid tiles are stored to
+};
 struct radio
 {
     SDL_Rect button;
     SDL_Color col;
     SDL_Rect bound;
-    SDL_Texture* text;
-    void (*action)(char**, int, int);
+    const char* text;
+    struct stamp* stamp;
 };
+struct atlas
+{
+    SDL_Texture* tex;
+    SDL_Rect glyph[ATLAS_GLYPHS];   //where each glyph sits in tex
+};
+struct changes
+{
+    FILE* out;
+    size_t len;
+    char buf[1 << 16];      //text waiting for out
+    //every column's x, formatted once: digits padded to 8 bytes, and how many
+    char (*x)[8];
+    unsigned char* xlen;
+};
+struct warp
+{
+    int on;
+    int gens;       //generations per rendered frame
+    double fps;     //target frame rate
+    double step;    //smoothed seconds per generation
+    double render;  //smoothed seconds per rendered frame
+};
+
+//set by SIGINT/SIGTERM so a headless server unlinks its ring on the way out
+volatile sig_atomic_t quit = 0;
+//the char grid was changed outside the engines, so the next run reloads it
+int edited = 1;
 
 //prototypes
+void onSignal(int sig);
 void px_init(struct px* elem);
-void radio_init(struct radio* elem, SDL_Renderer* r, char* str, void (*fun)( char**, int, int ));
-void countNeighbors(char c[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int n[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE]);
-void stepGen(char c[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int n[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE]);
-void updatePxFromChar(struct px p[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], char c[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE]);
-void renderGrid(SDL_Renderer* renderer, struct px arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE]);
-void renderRadio(SDL_Renderer* renderer, struct radio* elem);
+void radio_init(struct radio* elem, char* str, void (*fun)( char[STAMP_MAX][STAMP_MAX], int, int ));
+int fontPath(char* out, size_t len, const char* want);
+int fontHash(const char* path, uint64_t* hash);
+void atlas_init(struct atlas* elem, SDL_Renderer* r, const char* font);
+int atlasLoad(struct atlas* elem, SDL_Renderer* r, const char* bmp, const char* txt, const char* key);
+int atlasBuild(struct atlas* elem, SDL_Renderer* r, const char* font, const char* bmp, const char* txt, const char* key);
+void atlasDraw(struct atlas* elem, SDL_Renderer* r, const char* str, const SDL_Rect* bound, SDL_Color col);
+void stamp_init(struct stamp* elem, void (*fun)( char[STAMP_MAX][STAMP_MAX], int, int ));
+void stampTransform(struct stamp* dst, const struct stamp* src, int orient);
+void stampBlit(int w, int h, char arr[w][h], const struct stamp* elem, int x, int y, int mode);
+void editPush(struct edits* elem, int w, int h, char arr[w][h], int x, int y, int mode);
+void editLine(struct edits* elem, int w, int h, char arr[w][h], int x0, int y0, int x1, int y1, int mode);
+void editFlush(struct edits* elem, int w, int h, char arr[w][h]);
+void soupFill(int w, int h, char arr[w][h], double density, Uint64* seed);
+Uint64 splitmix64(Uint64* state);
+static inline __attribute__((always_inline)) void countNeighbors(int w, int h, char c[w][h], int n[w][h]);
+static inline __attribute__((always_inline)) void stepGen(int w, int h, char c[w][h], int n[w][h], char o[w][h]);
+void* engineStep(struct engine* elem, int w, int h, char c[w][h], int gens);
+void engineStore(struct engine* elem, int w, int h, char c[w][h]);
+void* engineRun(struct engine* elem, int w, int h, char c[w][h], int gens);
+void* classicStep(void* state, int w, int h, char c[w][h], int gens);
+void classicChanges(void* state, int w, int h, char c[w][h], void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg);
+void lutLoad(void* state, int w, int h, char c[w][h]);
+void* lutStepGrid(void* state, int w, int h, char c[w][h], int gens);
+void lutStoreRun(void* arg, int x, int y);
+void lutStore(void* state, int w, int h, char c[w][h]);
+void lutChangesGrid(void* state, int w, int h, char c[w][h], void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg);
+void tiledLoad(void* state, int w, int h, char c[w][h]);
+void* tiledStepGrid(void* state, int w, int h, char c[w][h], int gens);
+void tiledStoreTile(void* arg, uint64_t tx, uint64_t ty);
+void tiledStore(void* state, int w, int h, char c[w][h]);
+void tiledChangesGrid(void* state, int w, int h, char c[w][h], void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg);
+void adaptLoad(void* state, int w, int h, char c[w][h]);
+void* adaptStepGrid(void* state, int w, int h, char c[w][h], int gens);
+void adaptStore(void* state, int w, int h, char c[w][h]);
+void adaptChanges(void* state, int w, int h, char c[w][h], void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg);
+void updatePxFromChar(int vw, int vh, struct px p[vw][vh], int h, char c[][h]);
+void renderGrid(SDL_Renderer* renderer, int vw, int vh, struct px arr[vw][vh]);
+void renderRadio(SDL_Renderer* renderer, struct atlas* atlas, struct radio* elem);
+void warp_init(struct warp* elem, double fps);
+void warpUpdate(struct warp* elem, double stepTime, int stepped, double renderTime);
+long population(int w, int h, char c[w][h]);
+void changesGen(struct changes* elem, unsigned long gen);
+static inline int changesNumber(char* p, uint64_t v);
+void changesWord(void* arg, uint64_t x, uint64_t y, uint64_t born, uint64_t died);
+void changesCells(struct changes* elem, int w, int h, char c[w][h]);
+void changesFlush(struct changes* elem);
+void usage(const char* prog);
 //Statics
-void addBlock(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addBeehive(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addLoaf(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addBoat(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addTub(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
+void addBlock(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addBeehive(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addLoaf(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addBoat(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addTub(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
 //Oscillators
-void addBlinker(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addToad(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addBeacon(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addPulsar(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addTumbler(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addUnix(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addPentadecathlon(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
+void addBlinker(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addToad(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addBeacon(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addPulsar(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addTumbler(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addUnix(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addPentadecathlon(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
 //Spaceships
-void addGlider(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addLWSS(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
+void addGlider(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addLWSS(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
 //Guns
-void addGliderGun(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
+void addGliderGun(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
 //Shuttles
-void addTwinBeeShuttle(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addQueenBeeShuttle(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
+void addTwinBeeShuttle(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addQueenBeeShuttle(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
 //other
-void addPx(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addQueenBee(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
+void addPx(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addQueenBee(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
 //Methuselahs
-void addAcorn(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addSwitchEngine(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addBHeptomino(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
+void addAcorn(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addSwitchEngine(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addBHeptomino(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
 //Lakes
-void addPrePond(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addPond(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
-void addLake(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y);
+void addPrePond(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addPond(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
+void addLake(char arr[STAMP_MAX][STAMP_MAX], int x, int y);
 
 
 int main (int argc, char** argv) {
-    //init of SDL
-    SDL_Init(SDL_INIT_VIDEO);
-    TTF_Init();
-    SDL_Window* window = SDL_CreateWindow("C's GoL", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, WIN_WIDTH, WIN_HEIGHT, SDL_WINDOW_SHOWN);
-    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    //warp controller, many generations per rendered frame
+    struct warp warp;
+        warp_init(&warp, WARP_FPS);
+
+    //random soup, filled at start when density > 0
+    double density = 0;
+    Uint64 seed = SDL_GetPerformanceCounter();
+    //font for labels, searched for when not given
+    const char* font = NULL;
+    //generations to run without a window, -1 for interactive
+    long headless = -1;
+    //shared-memory ring to publish to, or to view from
+    const char* serve = NULL;
+    const char* attach = NULL;
+    struct ring ring;
+    //generations per second a server holds to, 0 for flat out
+    double rate = 0;
+    //births and deaths of every generation, as text
+    const char* changes = NULL;
+    struct changes chg;
+    //export of generations to disk
+    const char* record = NULL;
+    int scale = 1;
+    struct rec rec;
+    //universe size, from --size or fitting the window; also the size of a new tile file
+    unsigned long long sw = 0, sh = 0;
+    int w, h;
+    //grid, counts, pixels and every engine's buffers, optionally on huge pages
+    struct arena arena;
+    int huge = 0;
+    //out-of-core universe in a tile file
+    const char* tiles = NULL;
+    struct tilefile tf;
+    //stepping engines, all equivalent; the first is countNeighbors/stepGen
+    struct classic classic;
+    struct lut lut;
+    struct tiled tiled, sparse;
+    int depth = TILED_DEPTH;
+    //threads stepping the sparse engine, 0 for one per CPU
+    int threads = 0;
+    //--depth or --threads given, which only the engines take
+    int tuned = 0;
+    struct pool pool;
+    struct adapt ad;
+    struct engine engines[] = {
+        { "classic", &classic, NULL, classicStep, NULL, classicChanges },
+        { "lut", &lut, lutLoad, lutStepGrid, lutStore, lutChangesGrid },
+        { "tiled", &tiled, tiledLoad, tiledStepGrid, tiledStore, tiledChangesGrid },
+        { "sparse", &sparse, tiledLoad, tiledStepGrid, tiledStore, tiledChangesGrid },
+        { "auto", &ad, adaptLoad, adaptStepGrid, adaptStore, adaptChanges },
+    };
+    int nengines = sizeof(engines)/sizeof(engines[0]);
+    //-1 until --engine picks one, then the first
+    int engine = -1;
+
+    //command line
+    int a;
+    for (a = 1; a < argc; ++a) {
+        if (!strcmp(argv[a], "-w") || !strcmp(argv[a], "--warp"))
+            warp.on = 1;
+        else if ((!strcmp(argv[a], "-f") || !strcmp(argv[a], "--fps")) && a+1 < argc)
+            warp.fps = atof(argv[++a]);
+        else if ((!strcmp(argv[a], "-s") || !strcmp(argv[a], "--soup")) && a+1 < argc)
+            density = atof(argv[++a]);
+        else if (!strcmp(argv[a], "--seed") && a+1 < argc)
+            seed = strtoull(argv[++a], NULL, 0);
+        else if (!strcmp(argv[a], "--font") && a+1 < argc)
+            font = argv[++a];
+        else if (!strcmp(argv[a], "--headless") && a+1 < argc)
+            headless = atol(argv[++a]);
+        else if (!strcmp(argv[a], "--serve") && a+1 < argc)
+            serve = argv[++a];
+        else if (!strcmp(argv[a], "--attach") && a+1 < argc)
+            attach = argv[++a];
+        else if (!strcmp(argv[a], "--rate") && a+1 < argc)
+            rate = atof(argv[++a]);
+        else if (!strcmp(argv[a], "--changes") && a+1 < argc)
+            changes = argv[++a];
+        else if (!strcmp(argv[a], "--record") && a+1 < argc)
+            record = argv[++a];
+        else if (!strcmp(argv[a], "--scale") && a+1 < argc)
+            scale = atoi(argv[++a]);
+        else if (!strcmp(argv[a], "--tiles") && a+1 < argc)
+            tiles = argv[++a];
+        else if (!strcmp(argv[a], "--size") && a+1 < argc && sscanf(argv[a+1], "%llux%llu", &sw, &sh) == 2 && sw && sh)
+            ++a;
+        else if (!strcmp(argv[a], "--depth") && a+1 < argc) {
+            depth = atoi(argv[++a]);
+            tuned = 1;
+        }
+        else if (!strcmp(argv[a], "--threads") && a+1 < argc) {
+            threads = atoi(argv[++a]);
+            tuned = 1;
+        }
+        else if (!strcmp(argv[a], "--huge"))
+            huge = 1;
+        else if (!strcmp(argv[a], "--engine") && a+1 < argc) {
+            ++a;
+            for (engine = 0; engine < nengines && strcmp(argv[a], engines[engine].name); ++engine);
+            if (engine == nengines) {
+                usage(argv[0]);
+                return 1;
+            }
+        }
+        else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (warp.fps <= 0 || density < 0 || density > 1 || (density > 0 && density < SOUP_MIN) || rate < 0 || depth < 1 || depth > TILED_HALO || threads < 0 || (serve && attach) || (changes && attach)
+        //a tile file is stepped on its own, with none of the engines, windows or outputs
+        || (tiles && (engine >= 0 || serve || attach || record || changes || tuned || huge))) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (engine < 0)
+        engine = 0;
 
     //misc vars
     //iterators
@@ -111,12 +369,28 @@ int main (int argc, char** argv) {
     int paused = 1;
     //step-by-step flag
     int next = 0;
-    //mouse coords
+    //pixels per cell on screen, and the cells across and down that fit
+    int cell, vw, vh;
+    //mouse coords, button held and last cell painted while dragging
     int mx, my;
-    //function pointer for next shape to be generated
-    void (*fun)( char**, int, int );
-        //init function pointer to Px
-        fun = addPx;
+    int drag = 0, lx = 0, ly = 0;
+    //generation counter, generations this frame
+    unsigned long gen = 0;
+    int steps;
+    //timing
+    Uint64 t0, t1, t2;
+    Uint64 freq = SDL_GetPerformanceFrequency();
+    Uint32 titled = 0;
+    char title[64];
+    //stamp for next shape to be generated, as selected and as oriented
+    struct stamp* sel;
+    struct stamp cur;
+    //orientation of selected stamp; rotations in low bits, flip in bit 2
+    int orient = 0;
+    //grid edits waiting for the next generation boundary, all of cur
+    struct edits edits;
+        edits.stamp = &cur;
+        edits.n = 0;
     //marker for currently selected radio
     struct px mark;
         px_init(&mark);
@@ -124,122 +398,440 @@ int main (int argc, char** argv) {
         mark.loc.y = BUTTON_SIZE/4;
     //event union
     SDL_Event e;
-    //arrays
+
+    //universe bigger than memory, stepped straight through the mapping
+    if (tiles) {
+        int made = tilefile_open(&tf, tiles, sw, sh);
+        if (made < 0) {
+            fprintf(stderr, "gol: can't open tile file %s%s\n", tiles, (sw && sh) ? "" : " (--size WxH to create one)");
+            return 1;
+        }
+        if (!made && sw && (sw != tf.head->w || sh != tf.head->h)) {
+            fprintf(stderr, "gol: tile file %s is %llux%llu, not %llux%llu\n", tiles,
+                    (unsigned long long)tf.head->w, (unsigned long long)tf.head->h, sw, sh);
+            tilefile_close(&tf);
+            return 1;
+        }
+        if (made && density > 0)
+            tilefileSoup(&tf, density, splitmix64, &seed);
+        if (headless > 0)
+            tilefileStep(&tf, headless);
+        printf("gen %llu population %llu\n", (unsigned long long)tf.head->gen, (unsigned long long)tilefilePopulation(&tf));
+        tilefile_close(&tf);
+        return 0;
+    }
+    //viewer, generations come from a server instead of being stepped here, at its size
+    if (attach) {
+        if (ring_attach(&ring, attach) != 0) {
+            fprintf(stderr, "gol: can't attach to ring %s: %s\n", attach, errno ? strerror(errno) : "not a gol ring");
+            return 1;
+        }
+        if (sw && (sw != ring.head->w || sh != ring.head->h)) {
+            fprintf(stderr, "gol: ring %s is %ux%u, not %llux%llu\n", attach, ring.head->w, ring.head->h, sw, sh);
+            ring_close(&ring);
+            return 1;
+        }
+        sw = ring.head->w;
+        sh = ring.head->h;
+    }
+    if (sw > GRID_MAX || sh > GRID_MAX) {
+        fprintf(stderr, "gol: %llux%llu is more than %ix%i cells, step it with --tiles\n", sw, sh, GRID_MAX, GRID_MAX);
+        return 1;
+    }
+    w = sw ? (int)sw : WIN_WIDTH/PX_SIZE;
+    h = sh ? (int)sh : WIN_HEIGHT/PX_SIZE;
+
+    //arrays, all carved from one reservation that only costs what gets touched;
+    //12 bytes a cell of the universe rounded to whole tiles covers the lot,
+    //with the auto engine's memo tables on top
+    pool_init(&pool, threads);
+    if (arena_init(&arena, (size_t)((w + TILE-1) & ~(TILE-1))*((h + TILE-1) & ~(TILE-1))*12
+                           + sizeof(struct px)*WIN_WIDTH*WIN_HEIGHT + memoBytes((uint64_t)((w + TILE-1)/TILE)*((h + TILE-1)/TILE), pool.threads) + ((size_t)1 << 20), huge) != 0) {
+        fprintf(stderr, "gol: can't reserve memory for %ix%i cells: %s\n", w, h, strerror(errno));
+        return 1;
+    }
+    if (huge && !arena.huge)
+        fprintf(stderr, "gol: no huge pages, using normal ones\n");
     //grid of chars with LIVE and DEAD
-    char grid[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE];
-        for (j = 0; j < WIN_HEIGHT/PX_SIZE; ++j)
-            for (i = 0; i < WIN_WIDTH/PX_SIZE; ++i)
-                grid[i][j] = DEAD;
-    //grid of count of living neighbours
-    int ln[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE];
-        for (j = 0; j < WIN_HEIGHT/PX_SIZE; ++j)
-            for (i = 0; i < WIN_WIDTH/PX_SIZE; ++i)
-                ln[i][j] = 0;
-    //pixel array
-    struct px pixels[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE];
-        for ( i = 0; i < WIN_WIDTH/PX_SIZE; ++i ) {
-            for ( j = 0; j < WIN_HEIGHT/PX_SIZE; ++j ) {
+    char (*grid)[h] = arenaAlloc(&arena, (size_t)w*h);
+    //neighbour counts and the second plane for the classic engine, never touched by the others
+    classic.n = arenaAlloc(&arena, (size_t)w*h*sizeof(int));
+    classic.spare = arenaAlloc(&arena, (size_t)w*h);
+    classic.row = arenaAlloc(&arena, (size_t)2*h*sizeof(uint64_t));
+        if (!grid || !classic.n || !classic.spare || !classic.row) {
+            fprintf(stderr, "gol: out of memory\n");
+            return 1;
+        }
+        memset(grid, DEAD, (size_t)w*h);
+        if (density > 0)
+            soupFill(w, h, grid, density, &seed);
+
+    if (lut_init(&lut, w, h, &arena) != 0 || tiled_init(&tiled, w, h, &arena) != 0 || tiled_init(&sparse, w, h, &arena) != 0) {
+        fprintf(stderr, "gol: out of memory\n");
+        return 1;
+    }
+    tiled.k = depth;
+    sparse.pool = &pool;
+    if (adapt_init(&ad, w, h, depth, &pool, &arena) != 0) {
+        fprintf(stderr, "gol: out of memory\n");
+        return 1;
+    }
+
+    //recording runs on its own threads from here on
+    if (record && rec_init(&rec, record, w, h, scale, (int)warp.fps) != 0) {
+        fprintf(stderr, "gol: can't record to %s (want .y4m, .gif or .png)\n", record);
+        return 1;
+    }
+    //without a window nothing is waiting on the next frame, so keep every generation
+    rec.wait = headless >= 0 || serve || changes;
+
+    //windowless viewer: take every generation a server publishes up to --headless, recording it
+    if (attach && headless >= 0) {
+        long g, last = -1;
+
+        signal(SIGINT, onSignal);
+        signal(SIGTERM, onSignal);
+        while (!quit && last < headless) {
+            g = ringStep(&ring, &grid[0][0], LIVE, DEAD);
+            if (g < 0) {
+                SDL_Delay(1);
+                continue;
+            }
+            //a resync after falling behind can go back over generations already taken
+            if (g <= last)
+                continue;
+            last = g;
+            if (record)
+                recPush(&rec, g, &grid[0][0], LIVE);
+        }
+        ring_close(&ring);
+        if (record)
+            rec_close(&rec);
+        pool_close(&pool);
+        printf("gen %li population %li\n", last, population(w, h, grid));
+        arena_free(&arena);
+        return 0;
+    }
+    //batch run or server, no SDL video and no TTF at all
+    if (headless >= 0 || serve || changes) {
+        if (serve && ring_create(&ring, serve, w, h) != 0) {
+            if (errno == EEXIST)
+                fprintf(stderr, "gol: ring %s already exists; if no server is using it, remove /dev/shm%s\n", serve, ring.name);
+            else
+                fprintf(stderr, "gol: can't create ring %s: %s\n", serve, strerror(errno));
+            return 1;
+        }
+        if (changes) {
+            chg.len = 0;
+            chg.out = strcmp(changes, "-") ? fopen(changes, "w") : stdout;
+            if (!chg.out) {
+                fprintf(stderr, "gol: can't write changes to %s: %s\n", changes, strerror(errno));
+                return 1;
+            }
+            chg.x = arenaAlloc(&arena, (size_t)w*sizeof(*chg.x));
+            chg.xlen = arenaAlloc(&arena, w);
+            if (!chg.x || !chg.xlen) {
+                fprintf(stderr, "gol: out of memory\n");
+                return 1;
+            }
+            for (i = 0; i < w; ++i)
+                chg.xlen[i] = changesNumber(chg.x[i], i);
+            //the stream starts from the whole board, then only what changes
+            changesGen(&chg, 0);
+            changesCells(&chg, w, h, grid);
+        }
+        if (serve || changes) {
+            signal(SIGINT, onSignal);
+            signal(SIGTERM, onSignal);
+        }
+        t0 = SDL_GetPerformanceCounter();
+        for (gen = 0; !quit; ++gen) {
+            if (serve)
+                ringPublish(&ring, gen, &grid[0][0], LIVE);
+            if (record)
+                recPush(&rec, gen, &grid[0][0], LIVE);
+            if (headless >= 0 && gen >= (unsigned long)headless)
+                break;
+            if (changes) {
+                //a generation at a time, so the engine can tell what it changed; the
+                //char grid is only brought up to date when something reads it
+                grid = engineStep(&engines[engine], w, h, grid, 1);
+                changesGen(&chg, gen + 1);
+                engines[engine].changes(engines[engine].state, w, h, grid, changesWord, &chg);
+                if (serve || record)
+                    engineStore(&engines[engine], w, h, grid);
+            }
+            //nobody looks at the generations in between, step them in one go
+            else if (!serve && !record && rate <= 0) {
+                grid = engineRun(&engines[engine], w, h, grid, headless - gen);
+                gen = headless - 1;
+                continue;
+            }
+            else
+                grid = engineRun(&engines[engine], w, h, grid, 1);
+            //hold the rate by sleeping off whatever time we're ahead
+            if (rate > 0) {
+                t1 = t0 + (Uint64)((gen+1)/rate*freq);
+                t2 = SDL_GetPerformanceCounter();
+                if (t1 > t2)
+                    SDL_Delay((Uint32)((t1 - t2)*1000/freq));
+            }
+        }
+        if (changes) {
+            engineStore(&engines[engine], w, h, grid);
+            changesFlush(&chg);
+            if (chg.out != stdout)
+                fclose(chg.out);
+        }
+        if (serve)
+            ring_close(&ring);
+        if (record)
+            rec_close(&rec);
+        pool_close(&pool);
+        //keep stdout to the stream when that's where it goes
+        fprintf(changes && chg.out == stdout ? stderr : stdout, "gen %lu population %li\n", gen, population(w, h, grid));
+        if (engines[engine].state == &ad)
+            fprintf(stderr, "gol: auto stepped %llu dense, %llu sparse, %llu memo (%llu of %llu lookups hit), %llu by cycle (period %llu)\n",
+                    (unsigned long long)ad.ran[ADAPT_DENSE_MODE], (unsigned long long)ad.ran[ADAPT_SPARSE_MODE],
+                    (unsigned long long)ad.ran[ADAPT_MEMO_MODE], (unsigned long long)ad.hits,
+                    (unsigned long long)(ad.hits + ad.misses), (unsigned long long)ad.ran[ADAPT_CYCLE_MODE], (unsigned long long)ad.period);
+        arena_free(&arena);
+        return 0;
+    }
+    //init of SDL
+    SDL_Init(SDL_INIT_VIDEO);
+    SDL_Window* window = SDL_CreateWindow("C's GoL", SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, WIN_WIDTH, WIN_HEIGHT, SDL_WINDOW_SHOWN);
+    SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    //glyphs for all labels, from cache when possible
+    struct atlas atlas;
+        atlas_init(&atlas, renderer, font);
+
+    //pixel array, shrinking cells for big universes and showing the top left of huge ones
+    cell = PX_SIZE;
+    if (w*PX_SIZE > WIN_WIDTH || h*PX_SIZE > WIN_HEIGHT)
+        cell = (WIN_WIDTH/w < WIN_HEIGHT/h) ? WIN_WIDTH/w : WIN_HEIGHT/h;
+    if (cell < 1)
+        cell = 1;
+    vw = (w < WIN_WIDTH/cell) ? w : WIN_WIDTH/cell;
+    vh = (h < WIN_HEIGHT/cell) ? h : WIN_HEIGHT/cell;
+    struct px (*pixels)[vh] = arenaAlloc(&arena, sizeof(struct px)*vw*vh);
+        if (!pixels) {
+            fprintf(stderr, "gol: out of memory\n");
+            return 1;
+        }
+        for ( i = 0; i < vw; ++i ) {
+            for ( j = 0; j < vh; ++j ) {
                 px_init(&pixels[i][j]);
-                pixels[i][j].loc.x = i*PX_SIZE;
-                pixels[i][j].loc.y = j*PX_SIZE;
+                pixels[i][j].loc.x = i*cell;
+                pixels[i][j].loc.y = j*cell;
+                pixels[i][j].loc.w = cell;
+                pixels[i][j].loc.h = cell;
             }
         }
     //radio buttons for functions
     struct radio buttons[GENERATORS];
+    struct stamp stamps[GENERATORS];
+        for (i = 0; i < GENERATORS; ++i)
+            buttons[i].stamp = &stamps[i];
         //set each button to a function
-        radio_init(&buttons[0], renderer, "Px", addPx);
-        radio_init(&buttons[1], renderer, "Block", addBlock);
-        radio_init(&buttons[2], renderer, "Beehive", addBeehive);
-        radio_init(&buttons[3], renderer, "Loaf", addLoaf);
-        radio_init(&buttons[4], renderer, "Boat", addBoat);
-        radio_init(&buttons[5], renderer, "Tub", addTub);
-        radio_init(&buttons[6], renderer, "Blinker", addBlinker);
-        radio_init(&buttons[7], renderer, "Toad", addToad);
-        radio_init(&buttons[8], renderer, "Beacon", addBeacon);
-        radio_init(&buttons[9], renderer, "Pulsar", addPulsar);
-        radio_init(&buttons[10], renderer, "Pentadecathlon", addPentadecathlon);
-        radio_init(&buttons[11], renderer, "Glider", addGlider);
-        radio_init(&buttons[12], renderer, "LWSS", addLWSS);
-        radio_init(&buttons[13], renderer, "GliderGun", addGliderGun);
-        radio_init(&buttons[14], renderer, "QueenBee", addQueenBee);
-        radio_init(&buttons[15], renderer, "QueenBeeShuttle", addQueenBeeShuttle);
-        radio_init(&buttons[16], renderer, "TwinBeeShuttle", addTwinBeeShuttle);
-        radio_init(&buttons[17], renderer, "Unix", addUnix);
-        radio_init(&buttons[18], renderer, "Tumbler", addTumbler);
-        radio_init(&buttons[19], renderer, "Acorn", addAcorn);
-        radio_init(&buttons[20], renderer, "SwitchEngine", addSwitchEngine);
-        radio_init(&buttons[21], renderer, "BHeptomino", addBHeptomino);
-        radio_init(&buttons[22], renderer, "PrePond", addPrePond);
-        radio_init(&buttons[23], renderer, "Pond", addPond);
-        radio_init(&buttons[24], renderer, "Lake", addLake);
+        radio_init(&buttons[0], "Px", addPx);
+        radio_init(&buttons[1], "Block", addBlock);
+        radio_init(&buttons[2], "Beehive", addBeehive);
+        radio_init(&buttons[3], "Loaf", addLoaf);
+        radio_init(&buttons[4], "Boat", addBoat);
+        radio_init(&buttons[5], "Tub", addTub);
+        radio_init(&buttons[6], "Blinker", addBlinker);
+        radio_init(&buttons[7], "Toad", addToad);
+        radio_init(&buttons[8], "Beacon", addBeacon);
+        radio_init(&buttons[9], "Pulsar", addPulsar);
+        radio_init(&buttons[10], "Pentadecathlon", addPentadecathlon);
+        radio_init(&buttons[11], "Glider", addGlider);
+        radio_init(&buttons[12], "LWSS", addLWSS);
+        radio_init(&buttons[13], "GliderGun", addGliderGun);
+        radio_init(&buttons[14], "QueenBee", addQueenBee);
+        radio_init(&buttons[15], "QueenBeeShuttle", addQueenBeeShuttle);
+        radio_init(&buttons[16], "TwinBeeShuttle", addTwinBeeShuttle);
+        radio_init(&buttons[17], "Unix", addUnix);
+        radio_init(&buttons[18], "Tumbler", addTumbler);
+        radio_init(&buttons[19], "Acorn", addAcorn);
+        radio_init(&buttons[20], "SwitchEngine", addSwitchEngine);
+        radio_init(&buttons[21], "BHeptomino", addBHeptomino);
+        radio_init(&buttons[22], "PrePond", addPrePond);
+        radio_init(&buttons[23], "Pond", addPond);
+        radio_init(&buttons[24], "Lake", addLake);
         //set vertical offset
         for (i = 0; i < GENERATORS; ++i) {
             buttons[i].button.y = i*(WIN_HEIGHT/GENERATORS);
             buttons[i].bound.y = buttons[i].button.y;
         }
+        //init stamp to Px
+        sel = buttons[0].stamp;
+        stampTransform(&cur, sel, orient);
 
     //main loop
-    while (1) {
-        if (SDL_PollEvent(&e)) {
-            if (e.type == SDL_KEYDOWN) {
+    while (!quit) {
+        //drain every pending event; grid edits queue up until the step
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_QUIT)
+                quit = 1;
+            else if (e.type == SDL_KEYDOWN) {
                 if (e.key.keysym.sym == SDLK_ESCAPE)
-                    break;
+                    quit = 1;
                 else if (e.key.keysym.sym == SDLK_p)    //toggle paused with p
                     paused = !paused;
                 else if (e.key.keysym.sym == SDLK_SPACE)//advance frame with space
                     next = 1;
+                else if (e.key.keysym.sym == SDLK_w) {  //toggle warp with w
+                    warp.on = !warp.on;
+                    warp.gens = 1;
+                }
+                else if (e.key.keysym.sym == SDLK_r) {  //rotate stamp clockwise with r
+                    editFlush(&edits, w, h, grid);
+                    orient = (orient & 4) | ((orient + 1) & 3);
+                    stampTransform(&cur, sel, orient);
+                }
+                else if (e.key.keysym.sym == SDLK_f) {  //mirror stamp with f
+                    editFlush(&edits, w, h, grid);
+                    orient ^= 4;
+                    stampTransform(&cur, sel, orient);
+                }
+                else if (e.key.keysym.sym == SDLK_e) {  //cycle stepping engines with e
+                    engine = (engine + 1) % nengines;
+                    edited = 1;
+                    //the old engine's pace means nothing for the new one
+                    warp.gens = 1;
+                }
+                else if (e.key.keysym.sym == SDLK_v)    //pause/resume recording with v
+                    rec.on = record && !rec.on;
+                else if (e.key.keysym.sym == SDLK_s && !attach) { //fill with random soup with s
+                    editFlush(&edits, w, h, grid);
+                    soupFill(w, h, grid, density > 0 ? density : SOUP_DENSITY, &seed);
+                }
             }
             else if (e.type == SDL_MOUSEBUTTONDOWN) {
-                SDL_GetMouseState(&mx, &my);
-                //add element
+                //use where the click happened, not where the mouse is now
+                mx = e.button.x;
+                my = e.button.y;
+                //add element; right button toggles cells instead of setting them
                 if (mx < buttons[0].button.x) {
-                    (*fun)( grid, mx/PX_SIZE, my/PX_SIZE );
+                    drag = (e.button.button == SDL_BUTTON_RIGHT) ? SDL_BUTTON_RIGHT : SDL_BUTTON_LEFT;
+                    lx = mx/cell;
+                    ly = my/cell;
+                    if (!attach)
+                        editPush(&edits, w, h, grid, lx, ly, drag == SDL_BUTTON_RIGHT ? STAMP_XOR : STAMP_OR);
                 }
-                //set function pointer
+                //set stamp
                 else {
                     for (i = 0; i < GENERATORS; ++i) {
                         if (my > buttons[i].button.y && my < (buttons[i].button.y + buttons[i].button.h))
                         {
-                            fun = buttons[i].action;
+                            editFlush(&edits, w, h, grid);
+                            sel = buttons[i].stamp;
+                            stampTransform(&cur, sel, orient);
                             //add marker
                             mark.loc.y = buttons[i].button.y + BUTTON_SIZE/4;
                         }
                     }
                 }
             }
+            else if (e.type == SDL_MOUSEMOTION && drag) {
+                //paint along the path between samples, not just at them
+                mx = e.motion.x < buttons[0].button.x ? e.motion.x : buttons[0].button.x - 1;
+                my = e.motion.y;
+                if (mx/cell != lx || my/cell != ly) {
+                    if (!attach)
+                        editLine(&edits, w, h, grid, lx, ly, mx/cell, my/cell, drag == SDL_BUTTON_RIGHT ? STAMP_XOR : STAMP_OR);
+                    lx = mx/cell;
+                    ly = my/cell;
+                }
+            }
+            else if (e.type == SDL_MOUSEBUTTONUP)
+                drag = 0;
         }
+        //the whole batch lands between generations
+        editFlush(&edits, w, h, grid);
 
         //handle pause/next
-        if (!paused || next) {
-            //count neighbours
-            countNeighbors(grid, ln);
-            //life happens
-            stepGen(grid, ln);
-            next = 0;
+        t0 = SDL_GetPerformanceCounter();
+        steps = 0;
+        if (next)
+            steps = 1;
+        else if (!paused)
+            steps = warp.on ? warp.gens : 1;
+        next = 0;
+        if (attach) {
+            //catch up to whatever the server has published
+            long g = -1, n;
+            if (record && rec.on) {
+                //a generation at a time so the recorder gets each one, a ring's worth per frame at most
+                for (i = 0; i < (int)ring.head->slots && (n = ringStep(&ring, &grid[0][0], LIVE, DEAD)) >= 0; ++i) {
+                    if ((unsigned long)n >= gen && n > g) {
+                        recPush(&rec, n, &grid[0][0], LIVE);
+                        g = n;
+                    }
+                }
+            }
+            else
+                g = ringRead(&ring, &grid[0][0], LIVE, DEAD);
+            steps = (g >= 0 && (unsigned long)g + 1 > gen) ? g + 1 - gen : 0;
         }
-        else {
-            next = 0;
+        else if (record && rec.on) {
+            //the recorder wants every generation
+            for (i = 0; i < steps; ++i) {
+                grid = engineRun(&engines[engine], w, h, grid, 1);
+                recPush(&rec, gen + i + 1, &grid[0][0], LIVE);
+            }
         }
+        else if (steps > 0)
+            grid = engineRun(&engines[engine], w, h, grid, steps);
+        gen += steps;
+        t1 = SDL_GetPerformanceCounter();
 
         //update pixel array from grid
-        updatePxFromChar(pixels, grid);
+        updatePxFromChar(vw, vh, pixels, h, grid);
 
         //rendering
         SDL_SetRenderDrawColor(renderer, 0, 0xFF, 0, 0xFF);
         SDL_RenderClear(renderer);
         //render pixel array
-        renderGrid(renderer, pixels);
+        renderGrid(renderer, vw, vh, pixels);
         //render radios
         for (i = 0; i < GENERATORS; ++i)
-            renderRadio( renderer, &buttons[i] );
+            renderRadio( renderer, &atlas, &buttons[i] );
         //render marker
         SDL_SetRenderDrawColor(renderer, mark.col.r, mark.col.g, mark.col.b, mark.col.a);
         SDL_RenderFillRect(renderer, &mark.loc);
         //render
         SDL_RenderPresent(renderer);
+        t2 = SDL_GetPerformanceCounter();
+
+        //pick generations per frame for the next frame
+        if (warp.on && !paused)
+            warpUpdate(&warp, (double)(t1 - t0)/freq, steps, (double)(t2 - t1)/freq);
+        //report progress twice a second
+        if (SDL_GetTicks() - titled > 500) {
+            titled = SDL_GetTicks();
+            //auto says which way it's stepping right now
+            const char* how = engines[engine].state == &ad ? ADAPT_MODE[ad.mode] : engines[engine].name;
+            if (warp.on)
+                snprintf(title, sizeof(title), "C's GoL - gen %lu, %s (warp x%i)", gen, how, warp.gens);
+            else
+                snprintf(title, sizeof(title), "C's GoL - gen %lu, %s", gen, how);
+            SDL_SetWindowTitle(window, title);
+        }
     }
 
     //cleanup
+    if (attach)
+        ring_close(&ring);
+    if (record)
+        rec_close(&rec);
+    pool_close(&pool);
+    arena_free(&arena);
+    if (atlas.tex)
+        SDL_DestroyTexture(atlas.tex);
+    SDL_DestroyRenderer(renderer);
+    SDL_DestroyWindow(window);
 
     //quit
     SDL_Quit();
@@ -259,7 +851,7 @@ void px_init(struct px* elem) {
     elem->col.b = 0;
     elem->col.a = 0xFF;
 }
-void radio_init(struct radio* elem, SDL_Renderer* r, char* str, void (*fun)( char**, int, int )) {
+void radio_init(struct radio* elem, char* str, void (*fun)( char[STAMP_MAX][STAMP_MAX], int, int )) {
     //button
     elem->button.x = 7*WIN_WIDTH/8;;
     elem->button.y = 0;
@@ -276,20 +868,705 @@ void radio_init(struct radio* elem, SDL_Renderer* r, char* str, void (*fun)( cha
     elem->bound.y = 0;
     elem->bound.w = 2*BUTTON_SIZE;
     elem->bound.h = BUTTON_SIZE;
-    //set texture from string
-    TTF_Font* f = TTF_OpenFont( FONT, FONT_SIZE );
-    SDL_Surface* s = TTF_RenderText_Solid( f, str, elem->col );
-    elem->text = SDL_CreateTextureFromSurface( r, s );
+    //drawn from the glyph atlas
+    elem->text = str;
+    //action
+    stamp_init(elem->stamp, fun);
+}
+int fontPath(char* out, size_t len, const char* want) {
+    struct stat st;
+    char* base = SDL_GetBasePath();
+    const char* env = getenv("GOL_FONT");
+    int i;
+
+    //explicit choice, environment, next to the binary, a level up, then cwd relative
+    for (i = 0; i < 5; ++i) {
+        if (i == 0 && want)
+            snprintf(out, len, "%s", want);
+        else if (i == 1 && !want && env)
+            snprintf(out, len, "%s", env);
+        else if (i == 2 && !want && base)
+            snprintf(out, len, "%s%s", base, FONT_FILE);
+        else if (i == 3 && !want && base)
+            snprintf(out, len, "%s../%s", base, FONT_FILE);
+        else if (i == 4 && !want)
+            snprintf(out, len, "%s", FONT);
+        else
+            continue;
+        if (stat(out, &st) == 0 && S_ISREG(st.st_mode)) {
+            SDL_free(base);
+            return 0;
+        }
+    }
+    SDL_free(base);
+    return -1;
+}
+//FNV-1a over the font file's bytes
+int fontHash(const char* path, uint64_t* hash) {
+    unsigned char buf[1 << 16];
+    size_t n, i;
+    int err;
+    FILE* f = fopen(path, "rb");
+
+    if (!f)
+        return -1;
+    *hash = 0xCBF29CE484222325ull;
+    while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+        for (i = 0; i < n; ++i)
+            *hash = (*hash ^ buf[i]) * 0x100000001B3ull;
+    err = ferror(f);
+    fclose(f);
+    return err ? -1 : 0;
+}
+void atlas_init(struct atlas* elem, SDL_Renderer* r, const char* font) {
+    char path[1024], bmp[1024], txt[1024], key[128];
+    uint64_t hash = 0;
+    char* pref;
+
+    elem->tex = NULL;
+    if (fontPath(path, sizeof(path), font) != 0) {
+        fprintf(stderr, "gol: can't find font %s, labels disabled (try --font or GOL_FONT)\n", font ? font : FONT_FILE);
+        return;
+    }
+    //cache is keyed on size and the font's bytes, and named for them, so
+    //another or an edited font never picks up one built from this one
+    pref = fontHash(path, &hash) == 0 ? SDL_GetPrefPath("gol", "gol") : NULL;
+    snprintf(key, sizeof(key), "gol-atlas %i %016llx", FONT_SIZE, (unsigned long long)hash);
+    snprintf(bmp, sizeof(bmp), "%satlas-%i-%016llx.bmp", pref ? pref : "", FONT_SIZE, (unsigned long long)hash);
+    snprintf(txt, sizeof(txt), "%satlas-%i-%016llx.txt", pref ? pref : "", FONT_SIZE, (unsigned long long)hash);
+
+    if (!pref || atlasLoad(elem, r, bmp, txt, key) != 0) {
+        if (atlasBuild(elem, r, path, pref ? bmp : NULL, txt, key) != 0)
+            fprintf(stderr, "gol: can't render font %s: %s, labels disabled\n", path, TTF_GetError());
+    }
+    SDL_free(pref);
+}
+int atlasLoad(struct atlas* elem, SDL_Renderer* r, const char* bmp, const char* txt, const char* key) {
+    char line[128];
+    int i;
+    FILE* f = fopen(txt, "r");
+    SDL_Surface* s;
+
+    if (!f)
+        return -1;
+    //first line must match the font we would build from
+    if (!fgets(line, sizeof(line), f) || strncmp(line, key, strlen(key)) || line[strlen(key)] != '\n') {
+        fclose(f);
+        return -1;
+    }
+    for (i = 0; i < ATLAS_GLYPHS; ++i) {
+        if (fscanf(f, "%i %i %i %i", &elem->glyph[i].x, &elem->glyph[i].y, &elem->glyph[i].w, &elem->glyph[i].h) != 4) {
+            fclose(f);
+            return -1;
+        }
+    }
+    fclose(f);
+
+    s = SDL_LoadBMP(bmp);
+    if (!s)
+        return -1;
+    SDL_SetColorKey(s, SDL_TRUE, SDL_MapRGB(s->format, 0, 0, 0));
+    elem->tex = SDL_CreateTextureFromSurface(r, s);
     SDL_FreeSurface(s);
+    return elem->tex ? 0 : -1;
+}
+int atlasBuild(struct atlas* elem, SDL_Renderer* r, const char* font, const char* bmp, const char* txt, const char* key) {
+    SDL_Color white = { 0xFF, 0xFF, 0xFF, 0xFF };
+    SDL_Surface* g[ATLAS_GLYPHS];
+    SDL_Surface* s;
+    TTF_Font* f;
+    FILE* out;
+    int i, x = 0, y = 0, row = 0;
+
+    //the only place TTF is touched, and only when there's no cache
+    if (TTF_Init() != 0)
+        return -1;
+    f = TTF_OpenFont( font, FONT_SIZE );
+    if (!f) {
+        TTF_Quit();
+        return -1;
+    }
+    //render every glyph once and lay them out in rows
+    for (i = 0; i < ATLAS_GLYPHS; ++i) {
+        g[i] = TTF_RenderGlyph_Solid( f, ATLAS_FIRST + i, white );
+        elem->glyph[i].w = g[i] ? g[i]->w : 0;
+        elem->glyph[i].h = g[i] ? g[i]->h : 0;
+        if (x + elem->glyph[i].w > ATLAS_WIDTH) {
+            x = 0;
+            y += row;
+            row = 0;
+        }
+        elem->glyph[i].x = x;
+        elem->glyph[i].y = y;
+        x += elem->glyph[i].w;
+        if (elem->glyph[i].h > row)
+            row = elem->glyph[i].h;
+    }
     TTF_CloseFont( f );
-    //action
-    elem->action = fun;
+    TTF_Quit();
+
+    //black background keyed out, so glyphs can be tinted per label
+    s = SDL_CreateRGBSurfaceWithFormat(0, ATLAS_WIDTH, y + row, 32, SDL_PIXELFORMAT_ARGB8888);
+    for (i = 0; i < ATLAS_GLYPHS; ++i) {
+        if (g[i]) {
+            if (s)
+                SDL_BlitSurface(g[i], NULL, s, &elem->glyph[i]);
+            SDL_FreeSurface(g[i]);
+        }
+    }
+    if (!s)
+        return -1;
+
+    //cache for the next start; failing to is not an error
+    if (bmp && SDL_SaveBMP(s, bmp) == 0 && (out = fopen(txt, "w"))) {
+        fprintf(out, "%s\n", key);
+        for (i = 0; i < ATLAS_GLYPHS; ++i)
+            fprintf(out, "%i %i %i %i\n", elem->glyph[i].x, elem->glyph[i].y, elem->glyph[i].w, elem->glyph[i].h);
+        fclose(out);
+    }
+
+    SDL_SetColorKey(s, SDL_TRUE, SDL_MapRGB(s->format, 0, 0, 0));
+    elem->tex = SDL_CreateTextureFromSurface(r, s);
+    SDL_FreeSurface(s);
+    return elem->tex ? 0 : -1;
+}
+void atlasDraw(struct atlas* elem, SDL_Renderer* r, const char* str, const SDL_Rect* bound, SDL_Color col) {
+    SDL_Rect dst;
+    const char* c;
+    int total = 0, x = 0, k;
+
+    if (!elem->tex)
+        return;
+    //stretch the run of glyphs over bound, as the old per-label textures were
+    for (c = str; *c; ++c) {
+        k = *c - ATLAS_FIRST;
+        if (k >= 0 && k < ATLAS_GLYPHS)
+            total += elem->glyph[k].w;
+    }
+    if (total == 0)
+        return;
+    SDL_SetTextureColorMod(elem->tex, col.r, col.g, col.b);
+    for (c = str; *c; ++c) {
+        k = *c - ATLAS_FIRST;
+        if (k < 0 || k >= ATLAS_GLYPHS)
+            continue;
+        dst.x = bound->x + x*bound->w/total;
+        dst.y = bound->y;
+        dst.w = (x + elem->glyph[k].w)*bound->w/total - x*bound->w/total;
+        dst.h = bound->h;
+        SDL_RenderCopy(r, elem->tex, &elem->glyph[k], &dst);
+        x += elem->glyph[k].w;
+    }
+}
+void stamp_init(struct stamp* elem, void (*fun)( char[STAMP_MAX][STAMP_MAX], int, int )) {
+    int i, j;
+    char tmp[STAMP_MAX][STAMP_MAX];
+
+    //run generator once on a scratch grid and keep the bits it set
+    memset(tmp, DEAD, sizeof(tmp));
+    (*fun)( tmp, 0, 0 );
+    elem->w = 0;
+    elem->h = 0;
+    for (i = 0; i < STAMP_MAX; ++i) {
+        elem->col[i] = 0;
+        for (j = 0; j < STAMP_MAX; ++j) {
+            if (tmp[i][j] == LIVE) {
+                elem->col[i] |= (Uint64)1 << j;
+                if (i >= elem->w)
+                    elem->w = i+1;
+                if (j >= elem->h)
+                    elem->h = j+1;
+            }
+        }
+    }
+}
+void stampTransform(struct stamp* dst, const struct stamp* src, int orient) {
+    int i, j, k, x, y, t, w, h;
+
+    w = (orient & 1) ? src->h : src->w;
+    h = (orient & 1) ? src->w : src->h;
+    for (i = 0; i < STAMP_MAX; ++i)
+        dst->col[i] = 0;
+    for (i = 0; i < src->w; ++i) {
+        for (j = 0; j < src->h; ++j) {
+            if (!(src->col[i] >> j & 1))
+                continue;
+            //mirror left to right, then rotate clockwise a quarter at a time
+            x = (orient & 4) ? src->w-1 - i : i;
+            y = j;
+            for (k = 0; k < (orient & 3); ++k) {
+                t = x;
+                x = ((k & 1) ? src->w : src->h) - 1 - y;
+                y = t;
+            }
+            dst->col[x] |= (Uint64)1 << y;
+        }
+    }
+    dst->w = w;
+    dst->h = h;
+}
+void stampBlit(int w, int h, char arr[w][h], const struct stamp* elem, int x, int y, int mode) {
+    //byte masks for each 8 bit run of a column, built on first use
+    static Uint64 spread[256];
+    static Uint64 live, flip;
+    static int ready = 0;
+    int i, j, k, rows, top;
+    Uint64 bits, m, word;
+    unsigned char b[8];
+
+    if (!ready) {
+        for (i = 0; i < 256; ++i) {
+            for (k = 0; k < 8; ++k)
+                b[k] = (i >> k & 1) ? 0xFF : 0x00;
+            memcpy(&spread[i], b, 8);
+        }
+        memset(b, LIVE, 8);
+        memcpy(&live, b, 8);
+        memset(b, LIVE ^ DEAD, 8);
+        memcpy(&flip, b, 8);
+        ready = 1;
+    }
+
+    for (i = 0; i < elem->w; ++i) {
+        //clip columns
+        if (x+i < 0 || x+i >= w)
+            continue;
+        //clip rows
+        bits = elem->col[i];
+        top = y;
+        if (top < 0) {
+            if (-top >= STAMP_MAX)
+                continue;
+            bits >>= -top;
+            top = 0;
+        }
+        if (top >= h)
+            continue;
+        rows = h - top;
+        if (rows < STAMP_MAX)
+            bits &= ((Uint64)1 << rows) - 1;
+
+        //8 cells per store while a whole word fits in the column
+        char* c = &arr[x+i][top];
+        for (j = 0; bits; j += 8, bits >>= 8) {
+            if (!(bits & 0xFF))
+                continue;
+            if (rows - j >= 8) {
+                m = spread[bits & 0xFF];
+                memcpy(&word, c+j, 8);
+                if (mode == STAMP_XOR)
+                    word ^= m & flip;
+                else
+                    word = (word & ~m) | (live & m);
+                memcpy(c+j, &word, 8);
+            }
+            else {
+                for (k = 0; k < 8 && j+k < rows; ++k) {
+                    if (bits >> k & 1)
+                        c[j+k] = (mode == STAMP_XOR) ? (c[j+k] == LIVE ? DEAD : LIVE) : LIVE;
+                }
+            }
+        }
+    }
+}
+void editPush(struct edits* elem, int w, int h, char arr[w][h], int x, int y, int mode) {
+    //a full queue just lands early, still before the step
+    if (elem->n == EDIT_MAX)
+        editFlush(elem, w, h, arr);
+    elem->e[elem->n].x = x;
+    elem->e[elem->n].y = y;
+    elem->e[elem->n].mode = mode;
+    ++elem->n;
 }
-void countNeighbors(char c[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int n[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE]) {
+void editLine(struct edits* elem, int w, int h, char arr[w][h], int x0, int y0, int x1, int y1, int mode) {
+    //bresenham, (x0, y0) was painted by the previous sample
+    int dx = abs(x1 - x0), sx = x0 < x1 ? 1 : -1;
+    int dy = -abs(y1 - y0), sy = y0 < y1 ? 1 : -1;
+    int err = dx + dy, e2;
+
+    while (x0 != x1 || y0 != y1) {
+        e2 = 2*err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+        editPush(elem, w, h, arr, x0, y0, mode);
+    }
+}
+void editFlush(struct edits* elem, int w, int h, char arr[w][h]) {
+    int i;
+
+    for (i = 0; i < elem->n; ++i)
+        stampBlit(w, h, arr, elem->stamp, elem->e[i].x, elem->e[i].y, elem->e[i].mode);
+    if (elem->n)
+        edited = 1;
+    elem->n = 0;
+}
+void soupFill(int w, int h, char arr[w][h], double density, Uint64* seed) {
     int i, j;
+    //a cell is LIVE when its random 32 bits fall under the threshold, so sparse soups stay sparse
+    Uint64 t = (Uint64)(density*4294967296.0 + 0.5);
+    Uint64 r;
 
-    for (j = 0; j < WIN_HEIGHT/PX_SIZE; ++j) {
-        for (i = 0; i < WIN_WIDTH/PX_SIZE; ++i) {
+    for (i = 0; i < w; ++i) {
+        for (j = 0; j + 2 <= h; j += 2) {
+            r = splitmix64(seed);
+            arr[i][j] = ((r & 0xFFFFFFFF) < t) ? LIVE : DEAD;
+            arr[i][j+1] = ((r >> 32) < t) ? LIVE : DEAD;
+        }
+        if (j < h)
+            arr[i][j] = ((splitmix64(seed) & 0xFFFFFFFF) < t) ? LIVE : DEAD;
+    }
+    edited = 1;
+}
+Uint64 splitmix64(Uint64* state) {
+    Uint64 z = (*state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+void onSignal(int sig) {
+    (void)sig;
+    quit = 1;
+}
+void warp_init(struct warp* elem, double fps) {
+    elem->on = 0;
+    elem->gens = 1;
+    elem->fps = fps;
+    elem->step = 0;
+    elem->render = 0;
+}
+void warpUpdate(struct warp* elem, double stepTime, int stepped, double renderTime) {
+    //smooth measurements so one slow frame doesn't whipsaw the count
+    if (stepped > 0) {
+        if (elem->step > 0)
+            elem->step = 0.8*elem->step + 0.2*(stepTime/stepped);
+        else
+            elem->step = stepTime/stepped;
+    }
+    if (elem->render > 0)
+        elem->render = 0.8*elem->render + 0.2*renderTime;
+    else
+        elem->render = renderTime;
+
+    //whatever the frame budget leaves after rendering goes to stepping
+    double budget = 1.0/elem->fps - elem->render;
+    double want = elem->step > 0 ? budget/elem->step : 2*elem->gens;
+    //at most double per frame, and always make progress
+    if (want > 2.0*elem->gens)
+        want = 2.0*elem->gens;
+    if (want > WARP_MAX)
+        want = WARP_MAX;
+    if (want < 1)
+        want = 1;
+    elem->gens = (int)want;
+}
+void changesGen(struct changes* elem, unsigned long gen) {
+    if (elem->len > sizeof(elem->buf) - 32)
+        changesFlush(elem);
+    elem->len += snprintf(elem->buf + elem->len, 32, "g %lu\n", gen);
+}
+static inline int changesNumber(char* p, uint64_t v) {
+    static const char pairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    uint64_t t = 10;
+    int n = 1, i;
+
+    while (n < 20 && v >= t) {
+        ++n;
+        t *= 10;
+    }
+    //two digits per step from the right
+    for (i = n; i > 1; v /= 100) {
+        i -= 2;
+        memcpy(p + i, pairs + 2*(v % 100), 2);
+    }
+    if (i)
+        p[0] = '0' + v;
+    return n;
+}
+void changesWord(void* arg, uint64_t x, uint64_t y, uint64_t born, uint64_t died) {
+    struct changes* elem = arg;
+    uint64_t bits, i;
+    char tail[32], *p;
+    int n, sign;
+
+    //hand formatted, printf per cell can't keep up with the stepping;
+    //' y' and the newline are the same for every cell of the word
+    tail[0] = ' ';
+    n = 1 + changesNumber(tail + 1, y);
+    tail[n++] = '\n';
+    //room for all 64 cells, each a sign, x and the tail, both copied whole so
+    //the copies have a constant size
+    if (elem->len > sizeof(elem->buf) - 64*(1 + sizeof(*elem->x) + sizeof(tail)))
+        changesFlush(elem);
+    p = elem->buf + elem->len;
+    for (sign = 0; sign < 2; ++sign) {
+        for (bits = sign ? died : born; bits; bits &= bits-1) {
+            *p++ = sign ? '-' : '+';
+            i = x + __builtin_ctzll(bits);
+            memcpy(p, elem->x[i], sizeof(*elem->x));
+            p += elem->xlen[i];
+            memcpy(p, tail, sizeof(tail));
+            p += n;
+        }
+    }
+    elem->len = p - elem->buf;
+}
+void changesCells(struct changes* elem, int w, int h, char c[w][h]) {
+    uint64_t bits;
+    int i, j, x;
+
+    //every LIVE cell as born, a row word of 64 cells at a time
+    for (x = 0; x < w; x += 64) {
+        for (j = 0; j < h; ++j) {
+            bits = 0;
+            for (i = x; i < w && i < x+64; ++i)
+                bits |= (uint64_t)(c[i][j] == LIVE) << (i - x);
+            if (bits)
+                changesWord(elem, x, j, bits, 0);
+        }
+    }
+}
+void changesFlush(struct changes* elem) {
+    fwrite(elem->buf, 1, elem->len, elem->out);
+    elem->len = 0;
+}
+long population(int w, int h, char c[w][h]) {
+    int i, j;
+    long n = 0;
+
+    for (i = 0; i < w; ++i)
+        for (j = 0; j < h; ++j)
+            n += (c[i][j] == LIVE);
+    return n;
+}
+void usage(const char* prog) {
+    fprintf(stderr, "usage: %s [-w|--warp] [-f|--fps N] [-s|--soup DENSITY] [--seed N]\n"
+                    "          [--font PATH] [--headless GENS] [--serve NAME [--rate N] | --attach NAME]\n"
+                    "          [--record FILE [--scale N]] [--changes FILE] [--size WxH] [--tiles FILE] [--engine NAME [--depth K] [--threads N]] [--huge]\n", prog);
+    fprintf(stderr, "  -w, --warp    start in warp mode, many generations per frame (toggle with w)\n");
+    fprintf(stderr, "  -f, --fps N   frame rate warp mode aims to hold (default %.0f)\n", WARP_FPS);
+    fprintf(stderr, "  -s, --soup D  start from random soup with D of cells LIVE, 0 or %g to 1 (refill with s)\n", SOUP_MIN);
+    fprintf(stderr, "      --seed N  seed for the soup generator\n");
+    fprintf(stderr, "      --font P  label font (default: $GOL_FONT, then %s next to or above the binary)\n", FONT_FILE);
+    fprintf(stderr, "      --headless N  run N generations without a window, print the population\n");
+    fprintf(stderr, "      --serve R     step without a window, publishing every generation to shared-memory ring R,\n"
+                    "                    which must not exist yet and is removed on exit\n");
+    fprintf(stderr, "      --rate N      generations per second a server holds to (default flat out)\n");
+    fprintf(stderr, "      --attach R    show the generations a server publishes to ring R instead of stepping;\n"
+                    "                    with --headless N, take them without a window up to generation N\n");
+    fprintf(stderr, "      --record F    write generations to F.y4m, F.gif or F-<gen>.png in the background (pause with v)\n");
+    fprintf(stderr, "      --scale N     image pixels per cell when recording (default 1)\n");
+    fprintf(stderr, "      --changes F   without a window, write each generation to F (- for stdout) as a 'g N' line\n"
+                    "                    then '+x y' per birth and '-x y' per death; generation 0 is all births\n");
+    fprintf(stderr, "      --engine E    step with E: classic, lut (a 4x4 to 2x2 lookup table), tiled\n"
+                    "                    sparse (active tiles only, over threads) or auto (whichever suits the board,\n"
+                    "                    looking tiles up by their surroundings while a gun and its debris and the like\n"
+                    "                    keep repeating, skipping whole laps once the board repeats) (cycle with e)\n");
+    fprintf(stderr, "      --depth K     generations the tiled engine steps per visit to a block, 1 to %i (default %i)\n", TILED_HALO, TILED_DEPTH);
+    fprintf(stderr, "      --threads N   threads stepping the sparse and auto engines (default one per CPU),\n"
+                    "                    started the first time either steps\n");
+    fprintf(stderr, "      --tiles F     step the memory-mapped tile file F, --headless generations at a time;\n"
+                    "                    only -s, --seed and a --size matching an existing file go with it\n");
+    fprintf(stderr, "      --size WxH    cells in the universe, up to %ix%i (default what fits the window),\n"
+                    "                    or in a new tile file, soup filled with -s\n", GRID_MAX, GRID_MAX);
+    fprintf(stderr, "      --huge        keep the universe and engine buffers on huge pages when there are any\n");
+}
+void* engineStep(struct engine* elem, int w, int h, char c[w][h], int gens) {
+    //the state is kept between runs, so it only needs the grid again after edits
+    if (edited && elem->load)
+        elem->load(elem->state, w, h, c);
+    edited = 0;
+    return elem->step(elem->state, w, h, c, gens);
+}
+void engineStore(struct engine* elem, int w, int h, char c[w][h]) {
+    if (elem->store)
+        elem->store(elem->state, w, h, c);
+}
+void* engineRun(struct engine* elem, int w, int h, char c[w][h], int gens) {
+    c = engineStep(elem, w, h, c, gens);
+    engineStore(elem, w, h, c);
+    return c;
+}
+void* classicStep(void* state, int w, int h, char c[w][h], int gens) {
+    //counts, then the next generation into the spare plane, and swap the two
+    struct classic* s = state;
+    char (*o)[h];
+    int g;
+
+    for (g = 0; g < gens; ++g) {
+        o = (void*)s->spare;
+        //common sizes get bounds and strides the compiler folds in
+        #define CLASSIC_GEN(N) case N: countNeighbors(N, N, (void*)c, (void*)s->n); stepGen(N, N, (void*)c, (void*)s->n, (void*)o); break;
+        switch (w == h ? w : 0) {
+            GRID_SIZES(CLASSIC_GEN)
+            default:
+                //count neighbours
+                countNeighbors(w, h, c, (void*)s->n);
+                //life happens
+                stepGen(w, h, c, (void*)s->n, o);
+        }
+        #undef CLASSIC_GEN
+        s->spare = &c[0][0];
+        c = o;
+    }
+    return c;
+}
+void classicChanges(void* state, int w, int h, char c[w][h], void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg) {
+    //the spare plane holds the generation before
+    struct classic* s = state;
+    char (*o)[h] = (void*)s->spare;
+    uint64_t a, b, *born = s->row, *died = s->row + h;
+    int i, j, x;
+
+    //down the columns of a run of 64, then out as row words
+    for (x = 0; x < w; x += 64) {
+        memset(s->row, 0, (size_t)2*h*sizeof(uint64_t));
+        for (i = x; i < w && i < x+64; ++i) {
+            for (j = 0; j < h; ++j) {
+                //8 still cells at a time
+                if (j % 8 == 0 && j + 8 <= h) {
+                    memcpy(&a, &c[i][j], 8);
+                    memcpy(&b, &o[i][j], 8);
+                    if (a == b) {
+                        j += 7;
+                        continue;
+                    }
+                }
+                if (c[i][j] != o[i][j]) {
+                    born[j] |= (uint64_t)(c[i][j] == LIVE) << (i - x);
+                    died[j] |= (uint64_t)(o[i][j] == LIVE) << (i - x);
+                }
+            }
+        }
+        for (j = 0; j < h; ++j)
+            if (born[j] | died[j])
+                fn(arg, x, j, born[j], died[j]);
+    }
+}
+void lutLoad(void* state, int w, int h, char c[w][h]) {
+    int i, j;
+
+    lutClear(state);
+    for (i = 0; i < w; ++i)
+        for (j = 0; j < h; ++j)
+            if (c[i][j] == LIVE)
+                lutSet(state, i, j);
+}
+void* lutStepGrid(void* state, int w, int h, char c[w][h], int gens) {
+    (void)w;
+    (void)h;
+    lutStep(state, gens);
+    return c;
+}
+void lutStoreRun(void* arg, int x, int y) {
+    struct lutcopy* s = arg;
+    int i, j, x0 = x > 0 ? x-1 : 0, x1 = x+63 < s->l->w ? x+63 : s->l->w;
+    int y1 = y+2 < s->l->h ? y+2 : s->l->h;
+
+    for (i = x0; i < x1; ++i)
+        for (j = y; j < y1; ++j)
+            s->c[(size_t)i*s->l->h + j] = lutGet(s->l, i, j) ? LIVE : DEAD;
+}
+void lutStore(void* state, int w, int h, char c[w][h]) {
+    //only the runs that changed since the last store
+    struct lutcopy s = { state, &c[0][0] };
+
+    (void)w;
+    (void)h;
+    lutStale(state, lutStoreRun, &s);
+}
+void lutChangesGrid(void* state, int w, int h, char c[w][h], void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg) {
+    (void)w;
+    (void)h;
+    (void)c;
+    lutChanges(state, fn, arg);
+}
+void tiledLoad(void* state, int w, int h, char c[w][h]) {
+    int i, j;
+
+    tiledClear(state);
+    for (i = 0; i < w; ++i)
+        for (j = 0; j < h; ++j)
+            if (c[i][j] == LIVE)
+                tiledSet(state, i, j);
+}
+void* tiledStepGrid(void* state, int w, int h, char c[w][h], int gens) {
+    struct tiled* t = state;
+
+    (void)w;
+    (void)h;
+    if (t->pool)
+        tiledStepActive(t, gens);
+    else
+        tiledStep(t, gens);
+    return c;
+}
+void tiledStoreTile(void* arg, uint64_t tx, uint64_t ty) {
+    struct tilecopy* s = arg;
+    const uint64_t* tile = tiledTile(s->t, s->t->p, tx, ty);
+    uint64_t x, y, x1, y0 = ty*TILE, y1;
+    char* col;
+
+    x1 = (tx+1)*TILE < s->t->w ? (tx+1)*TILE : s->t->w;
+    y1 = y0 + TILE < s->t->h ? y0 + TILE : s->t->h;
+    for (x = tx*TILE; x < x1; ++x) {
+        col = s->c + x*s->h;
+        for (y = y0; y < y1; ++y)
+            col[y] = (tile[y - y0] >> (x % TILE) & 1) ? LIVE : DEAD;
+    }
+}
+void tiledStore(void* state, int w, int h, char c[w][h]) {
+    //only the tiles that changed since the last store
+    struct tilecopy s = { state, h, &c[0][0] };
+
+    (void)w;
+    tiledStale(state, tiledStoreTile, &s);
+}
+void tiledChangesGrid(void* state, int w, int h, char c[w][h], void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg) {
+    (void)w;
+    (void)h;
+    (void)c;
+    tiledChanges(state, fn, arg);
+}
+void adaptLoad(void* state, int w, int h, char c[w][h]) {
+    struct adapt* a = state;
+
+    tiledLoad(&a->t, w, h, c);
+    adaptReset(a);
+}
+void* adaptStepGrid(void* state, int w, int h, char c[w][h], int gens) {
+    (void)w;
+    (void)h;
+    adaptStep(state, gens);
+    return c;
+}
+void adaptStore(void* state, int w, int h, char c[w][h]) {
+    struct adapt* a = state;
+
+    tiledStore(&a->t, w, h, c);
+}
+void adaptChanges(void* state, int w, int h, char c[w][h], void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg) {
+    struct adapt* a = state;
+
+    (void)w;
+    (void)h;
+    (void)c;
+    tiledChanges(&a->t, fn, arg);
+}
+static inline __attribute__((always_inline)) void countNeighbors(int w, int h, char c[w][h], int n[w][h]) {
+    int i, j;
+
+    //down each column, the way the grid is laid out
+    for (i = 0; i < w; ++i) {
+        for (j = 0; j < h; ++j) {
             //clear
             n[i][j] = 0;
             //starting above, going clockwise; 2 to a block
@@ -297,23 +1574,23 @@ void countNeighbors(char c[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int n[WIN_WID
                 if (c[i][j-1] == LIVE) {
                     ++n[i][j];         //up
                 }
-                if (i < (WIN_WIDTH/PX_SIZE-1)) {
+                if (i < (w-1)) {
                     if (c[i+1][j-1] == LIVE) {
                         ++n[i][j];     //up-right
                     }
                 }
             }
-            if (i < (WIN_WIDTH/PX_SIZE-1)) {
+            if (i < (w-1)) {
                 if (c[i+1][j] == LIVE) {
                     ++n[i][j];         //right
                 }
-                if (i < (WIN_HEIGHT/PX_SIZE-1)) {
+                if (j < (h-1)) {
                     if (c[i+1][j+1] == LIVE) {
                         ++n[i][j];     //right-down
                     }
                 }
             }
-            if (j < (WIN_HEIGHT/PX_SIZE-1)) {
+            if (j < (h-1)) {
                 if (c[i][j+1] == LIVE) {
                     ++n[i][j];         //down
                 }
@@ -336,44 +1613,48 @@ void countNeighbors(char c[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int n[WIN_WID
         }
     }
 }
-void stepGen(char c[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int n[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE]) {
+static inline __attribute__((always_inline)) void stepGen(int w, int h, char c[w][h], int n[w][h], char o[w][h]) {
     int i, j;
 
-    for (j = 0; j < WIN_HEIGHT/PX_SIZE; ++j) {
-        for (i = 0; i < WIN_WIDTH/PX_SIZE; ++i) {
+    //down each column, the way the grid is laid out
+    for (i = 0; i < w; ++i) {
+        for (j = 0; j < h; ++j) {
             //3. birth
             if (c[i][j] == DEAD) {
                 if (n[i][j] == 3) {
-                    c[i][j] = LIVE;
+                    o[i][j] = LIVE;
+                }
+                else {
+                    o[i][j] = DEAD;
                 }
             }
             else if (c[i][j] == LIVE) {
                 //1. underpopulation
                 if (n[i][j] < 2) {
-                    c[i][j] = DEAD;
+                    o[i][j] = DEAD;
                 }
                 //2. overpopulation
                 else if (n[i][j] > 3) {
-                    c[i][j] = DEAD;
+                    o[i][j] = DEAD;
                 }
                 //4. life
-                else if ((n[i][j] == 2) || (n[i][j] == 3)) {
-                    c[i][j] = LIVE;
+                else {
+                    o[i][j] = LIVE;
                 }
             }
             else {
                 printf("Error: chars[%i %i] == %c\n", i, j, c[i][j]);
-                break;
+                o[i][j] = DEAD;
             }
         }
     }
 }
-void updatePxFromChar(struct px p[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], char c[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE]) {
+void updatePxFromChar(int vw, int vh, struct px p[vw][vh], int h, char c[][h]) {
     int i, j;
 
     //update pixel array from grid
-    for (j = 0; j < WIN_HEIGHT/PX_SIZE; ++j) {
-        for (i = 0; i < WIN_WIDTH/PX_SIZE; ++i) {
+    for (j = 0; j < vh; ++j) {
+        for (i = 0; i < vw; ++i) {
             if (c[i][j] == DEAD) {
                 p[i][j].age = 0;
                 p[i][j].col.r = 0xCC;
@@ -395,34 +1676,34 @@ void updatePxFromChar(struct px p[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], char c
         }
     }
 }
-void renderGrid(SDL_Renderer* renderer, struct px arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE]) {
+void renderGrid(SDL_Renderer* renderer, int vw, int vh, struct px arr[vw][vh]) {
     int i, j;
 
     //render pixel array
-    for ( i = 0; i < WIN_WIDTH/PX_SIZE; ++i ) {
-        for ( j = 0; j < WIN_HEIGHT/PX_SIZE; ++j ) {
+    for ( i = 0; i < vw; ++i ) {
+        for ( j = 0; j < vh; ++j ) {
             SDL_SetRenderDrawColor(renderer, arr[i][j].col.r, arr[i][j].col.g, arr[i][j].col.b, arr[i][j].col.a);
             SDL_RenderFillRect(renderer, &arr[i][j].loc);
         }
     }
 }
-void renderRadio(SDL_Renderer* renderer, struct radio* elem) {
+void renderRadio(SDL_Renderer* renderer, struct atlas* atlas, struct radio* elem) {
     //render radio button box
     SDL_SetRenderDrawColor( renderer, elem->col.r, elem->col.g, elem->col.b, elem->col.a );
     SDL_RenderFillRect( renderer, &elem->button );
 
     //render text
-    SDL_RenderCopy(renderer, elem->text, NULL, &elem->bound);
+    atlasDraw(atlas, renderer, elem->text, &elem->bound, elem->col);
 }
 //object generators
 //Statics
-void addBlock(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addBlock(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+0][y+0] = LIVE;
     arr[x+0][y+1] = LIVE;
     arr[x+1][y+0] = LIVE;
     arr[x+1][y+1] = LIVE;
 }
-void addBeehive(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addBeehive(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+0][y+1] = LIVE;
     arr[x+1][y+0] = LIVE;
     arr[x+1][y+2] = LIVE;
@@ -430,7 +1711,7 @@ void addBeehive(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     arr[x+2][y+2] = LIVE;
     arr[x+3][y+1] = LIVE;
 }
-void addLoaf(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addLoaf(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+0][y+1] = LIVE;
     arr[x+1][y+0] = LIVE;
     arr[x+1][y+2] = LIVE;
@@ -439,26 +1720,26 @@ void addLoaf(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     arr[x+3][y+1] = LIVE;
     arr[x+3][y+2] = LIVE;
 }
-void addBoat(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addBoat(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+0][y+0] = LIVE;
     arr[x+0][y+1] = LIVE;
     arr[x+1][y+0] = LIVE;
     arr[x+1][y+2] = LIVE;
     arr[x+2][y+1] = LIVE;
 }
-void addTub(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addTub(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+0][y+1] = LIVE;
     arr[x+1][y+0] = LIVE;
     arr[x+1][y+2] = LIVE;
     arr[x+2][y+1] = LIVE;
 }
 //Oscillators
-void addBlinker(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addBlinker(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+1][y+0] = LIVE;
     arr[x+1][y+1] = LIVE;
     arr[x+1][y+2] = LIVE;
 }
-void addToad(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addToad(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+0][y+1] = LIVE;
     arr[x+0][y+2] = LIVE;
     arr[x+1][y+3] = LIVE;
@@ -466,11 +1747,11 @@ void addToad(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     arr[x+3][y+1] = LIVE;
     arr[x+3][y+2] = LIVE;
 }
-void addBeacon(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addBeacon(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     addBlock(arr, x, y);
     addBlock(arr, x+2, y+2);
 }
-void addPulsar(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addPulsar(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //left bars
     arr[x+0][y+2] = LIVE;
     arr[x+0][y+3] = LIVE;
@@ -529,7 +1810,7 @@ void addPulsar(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     arr[x+5][y+4] = LIVE;
     
 }
-void addTumbler(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addTumbler(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //left pair
     arr[x+0][y+1] = LIVE;
     arr[x+0][y+2] = LIVE;
@@ -554,7 +1835,7 @@ void addTumbler(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     arr[x+8][y+1] = LIVE;
     arr[x+8][y+2] = LIVE;
 }
-void addUnix(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addUnix(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //top block
     addBlock(arr, x+1, y+0);
     //right block
@@ -571,7 +1852,7 @@ void addUnix(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     arr[x+2][y+7] = LIVE;
     arr[x+3][y+7] = LIVE;
 }
-void addPentadecathlon(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addPentadecathlon(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //top T part
     arr[x+0][y+2] = LIVE;
     arr[x+1][y+0] = LIVE;
@@ -600,14 +1881,14 @@ void addPentadecathlon(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, i
     arr[x+2][y+13] = LIVE;
 }
 //Spaceships
-void addGlider(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addGlider(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+1][y+0] = LIVE;
     arr[x+2][y+1] = LIVE;
     arr[x+0][y+2] = LIVE;
     arr[x+1][y+2] = LIVE;
     arr[x+2][y+2] = LIVE;
 }
-void addLWSS(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addLWSS(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     addBlock(arr, x, y+1);
     addBlock(arr, x+1, y);
     //bottom right L
@@ -619,7 +1900,7 @@ void addLWSS(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     arr[x+4][y+2] = LIVE;
 }
 //Guns
-void addGliderGun(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addGliderGun(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //make glider gun; L2R
     //left block
     addBlock(arr, x, y+4);
@@ -680,7 +1961,7 @@ void addGliderGun(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y)
     addBlock(arr, x+34, y+2);
 }
 //Shuttles
-void addTwinBeeShuttle(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addTwinBeeShuttle(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //Top-Left block
     addBlock(arr, x+0, y+1);
     //Bottom-Left block
@@ -706,7 +1987,7 @@ void addTwinBeeShuttle(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, i
     //Right block
     addBlock(arr, x+27, y+1);
 }
-void addQueenBeeShuttle(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) { //trans 
+void addQueenBeeShuttle(char arr[STAMP_MAX][STAMP_MAX], int x, int y) { //trans 
     //left block
     addBlock(arr, x+0, y+3);
     //queen
@@ -715,10 +1996,10 @@ void addQueenBeeShuttle(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x,
     addBlock(arr, x+20, y+2);
 }
 //other
-void addPx(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addPx(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+0][y+0] = LIVE;
 }
-void addQueenBee(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addQueenBee(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //tail
     arr[x][y] = LIVE;
     arr[x][y+1] = LIVE;
@@ -735,7 +2016,7 @@ void addQueenBee(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y)
     arr[x+3][y+4] = LIVE;
     arr[x+4][y+3] = LIVE;
 }
-void addAcorn(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addAcorn(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //left 3
     arr[x+0][y+2] = LIVE;
     arr[x+1][y+2] = LIVE;
@@ -746,7 +2027,7 @@ void addAcorn(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     arr[x+5][y+2] = LIVE;
     arr[x+6][y+2] = LIVE;
 }
-void addSwitchEngine(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addSwitchEngine(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //left 3
     arr[x+0][y+1] = LIVE;
     arr[x+1][y+0] = LIVE;
@@ -759,7 +2040,7 @@ void addSwitchEngine(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int
     arr[x+4][y+3] = LIVE;
     arr[x+5][y+3] = LIVE;
 }
-void addBHeptomino(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addBHeptomino(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     arr[x+0][y+0] = LIVE;
     arr[x+0][y+1] = LIVE;
     arr[x+1][y+1] = LIVE;
@@ -769,7 +2050,7 @@ void addBHeptomino(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y
     arr[x+3][y+0] = LIVE;
 }
 //Lakes
-void addPrePond(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addPrePond(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //triple
     arr[x+0][y+1] = LIVE;
     arr[x+1][y+0] = LIVE;
@@ -777,7 +2058,7 @@ void addPrePond(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     //tail
     arr[x+2][y+2] = LIVE;
 }
-void addPond(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addPond(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //top
     arr[x+1][y+0] = LIVE;
     arr[x+2][y+0] = LIVE;
@@ -791,7 +2072,7 @@ void addPond(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
     arr[x+0][y+1] = LIVE;
     arr[x+0][y+2] = LIVE;
 }
-void addLake(char arr[WIN_WIDTH/PX_SIZE][WIN_HEIGHT/PX_SIZE], int x, int y) {
+void addLake(char arr[STAMP_MAX][STAMP_MAX], int x, int y) {
     //top (going clockwise)
     arr[x+4][y+0] = LIVE;
     arr[x+5][y+0] = LIVE;
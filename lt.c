@@ -7,25 +7,102 @@
         4. Any LIVE cell with           2-3 living neighbours stays LIVE, life
 */
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
+#include "ring.h"
+#include "arena.h"
 
+//terminal shown, and the universe when -s doesn't say
 const int W = 128;
 const int H = 48;
 const char LIVE = '#';
 const char DEAD = '-';
 
+//print the top left W x H of a w x h grid
+void print(char* grid, int w, int h)
+{
+    int i, j;
+    for (j = 0; j < H && j < h; ++j)
+    {
+        for (i = 0; i < W && i < w; ++i)
+            printf("%c", grid[i*h + j]);
+        printf("\n");
+    }
+}
+
+//show what a server publishes to a ring instead of stepping here
+int view(const char* name)
+{
+    struct ring ring;
+    struct arena arena;
+    long g, shown = -1;
+
+    if (ring_attach(&ring, name) != 0)
+    {
+        fprintf(stderr, "lt: can't attach to ring %s\n", name);
+        return 1;
+    }
+    if (arena_init(&arena, (size_t)ring.head->w*ring.head->h, 0) != 0)
+    {
+        fprintf(stderr, "lt: out of memory\n");
+        return 1;
+    }
+    char* grid = arenaAlloc(&arena, (size_t)ring.head->w*ring.head->h);
+    memset(grid, DEAD, (size_t)ring.head->w*ring.head->h);
+
+    while(1)
+    {
+        g = ringRead(&ring, grid, LIVE, DEAD);
+        if (g > shown)
+        {
+            printf("gen %li\n", g);
+            print(grid, ring.head->w, ring.head->h);
+            shown = g;
+        }
+        usleep(100000);
+    }
+
+    ring_close(&ring);
+    arena_free(&arena);
+    return 0;
+}
+
 int main (int argc, char** argv)
 {
     int i, j;
+    int w = W, h = H;
+    struct arena arena;
+    if (argc == 3 && !strcmp(argv[1], "-a"))
+        return view(argv[2]);
+    else if (argc == 3 && !strcmp(argv[1], "-s") && sscanf(argv[2], "%ix%i", &w, &h) == 2 && w >= 3 && h >= 3)
+        ;
+    else if (argc != 1)
+    {
+        fprintf(stderr, "usage: %s [-s WxH | -a RING]\n", argv[0]);
+        return 1;
+    }
+
+    //both grids from one aligned arena
+    if (arena_init(&arena, 2*((size_t)w*h + ARENA_ALIGN), 0) != 0)
+    {
+        fprintf(stderr, "lt: out of memory\n");
+        return 1;
+    }
     //grid of chars with LIVE and DEAD
-    char grid[W][H];
-        for (j = 0; j < H; ++j)
-            for (i = 0; i < W; ++i)
-                grid[i][j] = DEAD;
+    char (*grid)[h] = arenaAlloc(&arena, (size_t)w*h);
     //grid of count of living neighbours
-    char ln[W][H];
-        for (j = 0; j < H; ++j)
-            for (i = 0; i < W; ++i)
+    char (*ln)[h] = arenaAlloc(&arena, (size_t)w*h);
+    if (!grid || !ln)
+    {
+        fprintf(stderr, "lt: out of memory\n");
+        return 1;
+    }
+        for (j = 0; j < h; ++j)
+            for (i = 0; i < w; ++i)
+                grid[i][j] = DEAD;
+        for (j = 0; j < h; ++j)
+            for (i = 0; i < w; ++i)
                 ln[i][j] = 0;
 
     //make top left glider
@@ -38,9 +115,9 @@ int main (int argc, char** argv)
     while(1)
     {
         //count neighbours
-        for (j = 0; j < H; ++j)
+        for (j = 0; j < h; ++j)
         {
-            for (i = 0; i < W; ++i)
+            for (i = 0; i < w; ++i)
             {
                 //clear
                 ln[i][j] = 0;
@@ -51,7 +128,7 @@ int main (int argc, char** argv)
                     {
                         ++ln[i][j];         //up
                     }
-                    if (i < (W-1))
+                    if (i < (w-1))
                     {
                         if (grid[i+1][j-1] == LIVE)
                         {
@@ -59,13 +136,13 @@ int main (int argc, char** argv)
                         }
                     }
                 }
-                if (i < (W-1))
+                if (i < (w-1))
                 {
                     if (grid[i+1][j] == LIVE)
                     {
                         ++ln[i][j];         //right
                     }
-                    if (i < (H-1))
+                    if (j < (h-1))
                     {
                         if (grid[i+1][j+1] == LIVE)
                         {
@@ -73,7 +150,7 @@ int main (int argc, char** argv)
                         }
                     }
                 }
-                if (j < (H-1))
+                if (j < (h-1))
                 {
                     if (grid[i][j+1] == LIVE)
                     {
@@ -105,9 +182,9 @@ int main (int argc, char** argv)
         }
 
         //life happens
-        for (j = 0; j < H; ++j)
+        for (j = 0; j < h; ++j)
         {
-            for (i = 0; i < W; ++i)
+            for (i = 0; i < w; ++i)
             {
                 //3. birth
                 if (grid[i][j] == DEAD)
@@ -144,12 +221,7 @@ int main (int argc, char** argv)
         }
 
         //render?
-        for (j = 0; j < H; ++j)
-        {
-            for (i = 0; i < W; ++i)
-                printf("%c", grid[i][j]);
-            printf("\n");
-        }
+        print(&grid[0][0], w, h);
 
         sleep(1);
     }
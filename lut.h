@@ -0,0 +1,212 @@
+/*
+    Conway's Game of Life Replica - lookup table stepping
+    Every 4x4 neighbourhood decides the 2x2 block at its centre, so one
+    64K entry table access advances four cells at once.
+
+    Rows are bit-packed with bit x+1 holding cell x, so the 4 columns
+    x-1..x+2 around an even x are the nibble at bit x. There is one pad
+    row above and below (two below for odd heights) and a pad word on
+    the right, all DEAD, so the edges need no special cases. Rows are
+    padded on to a whole number of cache lines, so every row starts on
+    one.
+
+    Stepping notes which words of each pair of rows changed, so a copy
+    of the universe kept elsewhere only needs those 64 cell runs again.
+    Right after a generation the other buffer is the one before it, so
+    its births and deaths are the difference of the two, a word at a
+    time.
+*/
+#ifndef LUT_H
+#define LUT_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena.h"
+
+//Uint64 per row of a w cell universe: cells, pad word, then up to a cache line
+#define LUT_WORDS(w) ((((w) + 1 + 63)/64 + 1 + 7) & ~(size_t)7)
+//square sizes lutStep has a specialized copy of the kernel for
+#define LUT_SIZES(X) X(256) X(512) X(1024) X(2048) X(4096) X(8192) X(16384) X(32768) X(65536)
+
+//bit 0 (x, y), bit 1 (x+1, y), bit 2 (x, y+1), bit 3 (x+1, y+1)
+static unsigned char LUT[1 << 16];
+
+struct lut
+{
+    int w, h;
+    size_t words;           //Uint64 per row, pad included
+    uint64_t* cur;
+    uint64_t* next;
+    //per word of each pair of rows, changed since the copy was brought up to date
+    unsigned char* stale;
+};
+
+static inline void lut_build(void) {
+    static int built = 0;
+    int i, k, cx, cy, x, y, n;
+
+    if (built)
+        return;
+    for (i = 0; i < (1 << 16); ++i) {
+        LUT[i] = 0;
+        for (k = 0; k < 4; ++k) {
+            //centre cell at row 1 or 2, column 1 or 2 of the window
+            cx = 1 + (k & 1);
+            cy = 1 + (k >> 1);
+            n = 0;
+            for (y = cy-1; y <= cy+1; ++y)
+                for (x = cx-1; x <= cx+1; ++x)
+                    if ((x != cx || y != cy) && (i >> (4*y + x) & 1))
+                        ++n;
+            if (n == 3 || (n == 2 && (i >> (4*cy + cx) & 1)))
+                LUT[i] |= 1 << k;
+        }
+    }
+    built = 1;
+}
+
+//row y of a buffer, y may be -1 (the pad row above)
+static inline uint64_t* lutRow(struct lut* l, uint64_t* buf, int y) {
+    return buf + (size_t)(y+1)*l->words;
+}
+static inline int lut_init(struct lut* l, int w, int h, struct arena* a) {
+    size_t rows = h + 3;
+
+    lut_build();
+    l->w = w;
+    l->h = h;
+    l->words = LUT_WORDS(w);
+    l->cur = arenaAlloc(a, rows*l->words*sizeof(uint64_t));
+    l->next = arenaAlloc(a, rows*l->words*sizeof(uint64_t));
+    l->stale = arenaAlloc(a, (size_t)(h/2 + 1)*l->words);
+    return (l->cur && l->next && l->stale) ? 0 : -1;
+}
+//empty, to be loaded from the copy lutStale keeps, which is then up to date
+static inline void lutClear(struct lut* l) {
+    memset(l->cur, 0, (size_t)(l->h + 3)*l->words*sizeof(uint64_t));
+    memset(l->stale, 0, (size_t)(l->h/2 + 1)*l->words);
+}
+static inline void lutSet(struct lut* l, int x, int y) {
+    lutRow(l, l->cur, y)[(x+1) >> 6] |= (uint64_t)1 << ((x+1) & 63);
+}
+static inline int lutGet(struct lut* l, int x, int y) {
+    return lutRow(l, l->cur, y)[(x+1) >> 6] >> ((x+1) & 63) & 1;
+}
+
+//4 bits from bit s of a padded row
+static inline unsigned lutNibble(const uint64_t* r, int s) {
+    int i = s >> 6, b = s & 63;
+    uint64_t v = r[i] >> b;
+    if (b > 60)
+        v |= r[i+1] << (64 - b);
+    return v & 15;
+}
+
+//one generation from cur into next; w, h and words are constants in the sized copies
+static inline __attribute__((always_inline)) void lutGen(struct lut* l, int w, int h, size_t words) {
+    const uint64_t *r0, *r1, *r2, *r3;
+    uint64_t *d0, *d1, lo, hi;
+    unsigned char* st;
+    unsigned idx, res;
+    int x, y, s;
+    size_t i;
+
+    memset(l->next, 0, (size_t)(h + 3)*words*sizeof(uint64_t));
+    for (y = 0; y < h; y += 2) {
+        r0 = l->cur + (size_t)y*words;
+        r1 = r0 + words;
+        r2 = r1 + words;
+        r3 = r2 + words;
+        d0 = l->next + (size_t)(y+1)*words;
+        d1 = d0 + words;
+        for (x = 0; x < w; x += 2) {
+            idx = lutNibble(r0, x) | lutNibble(r1, x) << 4 | lutNibble(r2, x) << 8 | lutNibble(r3, x) << 12;
+            res = LUT[idx];
+            //cells x, x+1 sit at bits x+1, x+2, split over two words only when x+1 is bit 63
+            s = x+1;
+            lo = res & 3;
+            hi = res >> 2;
+            d0[s >> 6] |= lo << (s & 63);
+            d1[s >> 6] |= hi << (s & 63);
+            if ((s & 63) == 63) {
+                d0[(s >> 6) + 1] |= lo >> 1;
+                d1[(s >> 6) + 1] |= hi >> 1;
+            }
+        }
+        //words of the pair that differ from the rows they replace
+        st = l->stale + (size_t)(y/2)*words;
+        for (i = 0; i < words; ++i)
+            st[i] |= ((d0[i] ^ r1[i]) | (d1[i] ^ r2[i])) != 0;
+    }
+    //odd sizes step one column or row past the edge; keep the pad DEAD
+    if (w & 1) {
+        for (y = 0; y < h; ++y)
+            l->next[(size_t)(y+1)*words + ((w + 1) >> 6)] &= ~((uint64_t)1 << ((w + 1) & 63));
+    }
+    if (h & 1)
+        memset(l->next + (size_t)(h+1)*words, 0, words*sizeof(uint64_t));
+}
+
+static inline void lutStep(struct lut* l, int gens) {
+    uint64_t* tmp;
+    int g;
+
+    for (g = 0; g < gens; ++g) {
+        //square power-of-two universes get their own copy with the sizes folded in
+        #define LUT_GEN(N) case N: lutGen(l, N, N, LUT_WORDS(N)); break;
+        switch (l->w == l->h ? l->w : 0) {
+            LUT_SIZES(LUT_GEN)
+            default:
+                lutGen(l, l->w, l->h, l->words);
+        }
+        #undef LUT_GEN
+        tmp = l->cur;
+        l->cur = l->next;
+        l->next = tmp;
+    }
+}
+
+//births and deaths of the generation lutStep just made, from the rows it
+//replaced: fn(arg, x, y, born, died) where bit i is cell (x+i, y)
+static inline void lutChanges(struct lut* l, void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg) {
+    const uint64_t *now, *was;
+    uint64_t a, b;
+    size_t i;
+    int y;
+
+    for (y = 0; y < l->h; ++y) {
+        now = lutRow(l, l->cur, y);
+        was = lutRow(l, l->next, y);
+        //cell x is bit x+1, so each word of cells straddles two of the row
+        for (i = 0; i*64 < (size_t)l->w; ++i) {
+            a = now[i] >> 1 | now[i+1] << 63;
+            b = was[i] >> 1 | was[i+1] << 63;
+            if (a != b)
+                fn(arg, i*64, y, a & ~b, b & ~a);
+        }
+    }
+}
+
+//fn(arg, x, y) for every run of cells x-1..x+62 in rows y and y+1 that changed
+//since the last call, x a multiple of 64; the copy fn keeps is then up to date
+static inline void lutStale(struct lut* l, void (*fn)(void*, int, int), void* arg) {
+    size_t i, n = (size_t)(l->h/2 + 1)*l->words;
+    uint64_t word;
+
+    for (i = 0; i < n; ++i) {
+        //whole words of still runs at a time
+        if (i % 8 == 0 && i + 8 <= n) {
+            memcpy(&word, l->stale + i, 8);
+            if (!word) {
+                i += 7;
+                continue;
+            }
+        }
+        if (l->stale[i])
+            fn(arg, (int)(i % l->words)*64, (int)(i / l->words)*2);
+    }
+    memset(l->stale, 0, n);
+}
+
+#endif
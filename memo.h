@@ -0,0 +1,239 @@
+/*
+    Conway's Game of Life Replica - memoized tile stepping
+    HashLife's idea at the scale of one tile: what a tile becomes
+    MEMO_GENS generations on depends only on it and the MEMO_GENS cells
+    around it, so results are kept in a table keyed by those cells.
+    Where a board is made of repeating structure, oscillating debris or
+    the works of a gun, the same neighbourhoods come round again and a
+    tile costs a hash and a copy instead of MEMO_GENS generations.
+
+    There is no quadtree and no recursion: the universe is bounded, with
+    DEAD outside, and every generation has to be there to be drawn or
+    streamed, so only the one level is memoized. Tiles whose halo leaves
+    the universe are stepped the same way, without the table.
+
+    Like tiledStepActive it steps only active tiles, on the pool, and
+    each thread has a table of its own, so lookups take no locks. A tile
+    counts as changed if it moved in any of the generations stepped, so
+    the active tiles are still right for single generations after it.
+*/
+#ifndef MEMO_H
+#define MEMO_H
+
+#include <stdint.h>
+#include <string.h>
+#include "arena.h"
+#include "sched.h"
+#include "tiles.h"
+
+#define MEMO_GENS 15        //generations per lookup, at most TILE/2 and TILED_HALO
+#define MEMO_ROWS (TILE + 2*MEMO_GENS)
+#define MEMO_SLOTS 4        //entries per tile, over all threads
+#define MEMO_WAYS 4         //entries a key may sit in
+//a tile and its halo is a strip of two words a row, cells x0-MEMO_GENS on
+#define MEMO_SIDE ((((uint64_t)1 << 2*MEMO_GENS) - 1))
+
+struct memo_entry
+{
+    uint64_t hash;          //0 for an empty slot
+    uint64_t key[2][MEMO_ROWS];
+    uint64_t out[TILE];
+    int moved;              //changed in some generation on the way
+};
+struct memo_thread
+{
+    struct memo_entry* table;
+    uint64_t slots;         //a power of two
+    uint64_t ws[2][2][TILE + 2*TILED_HALO];
+    uint64_t hits, misses;
+} __attribute__((aligned(64)));
+struct memo
+{
+    struct tiled* t;
+    int threads;
+    struct memo_thread* thread;
+};
+//slots in each thread's table; a thread mostly sees its share of the tiles
+static inline uint64_t memoSlots(uint64_t tiles, int threads) {
+    uint64_t slots = 64*MEMO_WAYS;
+
+    while (slots*threads < tiles*MEMO_SLOTS)
+        slots *= 2;
+    return slots;
+}
+//arena bytes memo_init takes
+static inline size_t memoBytes(uint64_t tiles, int threads) {
+    return threads*(sizeof(struct memo_thread) + memoSlots(tiles, threads)*sizeof(struct memo_entry) + 2*ARENA_ALIGN);
+}
+
+static inline int memo_init(struct memo* m, struct tiled* t, int threads, struct arena* a) {
+    uint64_t slots = memoSlots(t->tw*t->th, threads);
+    int i;
+
+    m->t = t;
+    m->threads = threads;
+    m->thread = arenaAlloc(a, threads*sizeof(struct memo_thread));
+    if (!m->thread)
+        return -1;
+    memset(m->thread, 0, threads*sizeof(struct memo_thread));
+    for (i = 0; i < threads; ++i) {
+        m->thread[i].slots = slots;
+        if (!(m->thread[i].table = arenaAlloc(a, slots*sizeof(struct memo_entry))))
+            return -1;
+    }
+    return 0;
+}
+
+//of the 64 cells from x, the ones inside the universe
+static inline uint64_t memoKeep(struct tiled* t, int64_t x) {
+    uint64_t keep = ~(uint64_t)0;
+
+    if (x < 0)
+        keep = x <= -TILE ? 0 : keep << -x;
+    if (x + TILE > (int64_t)t->w)
+        keep &= x >= (int64_t)t->w ? 0 : ((uint64_t)1 << (t->w - x)) - 1;
+    return keep;
+}
+//the tile and its halo into ws[0], with rows top to bottom inside the
+//universe; returns whether all of it is, which is what the table keys on
+static inline int memoGather(struct tiled* t, uint64_t tx, uint64_t ty, uint64_t (*ws)[2][TILE + 2*TILED_HALO], uint64_t* keep, int* top, int* bottom) {
+    const uint64_t *w, *c, *e;
+    int64_t x0 = (int64_t)(tx*TILE) - MEMO_GENS, Y;
+    int i;
+
+    keep[0] = memoKeep(t, x0);
+    keep[1] = memoKeep(t, x0 + TILE) & MEMO_SIDE;
+    *top = ty ? 0 : MEMO_GENS;
+    *bottom = t->h - ty*TILE + MEMO_GENS < MEMO_ROWS ? (int)(t->h - ty*TILE + MEMO_GENS) : MEMO_ROWS;
+    for (i = 0; i < MEMO_ROWS; ++i) {
+        if (i < *top || i >= *bottom) {
+            ws[0][0][i] = ws[0][1][i] = ws[1][0][i] = ws[1][1][i] = 0;
+            continue;
+        }
+        Y = (int64_t)(ty*TILE) - MEMO_GENS + i;
+        w = tx ? tiledTile(t, t->p, tx-1, Y/TILE) : NULL;
+        c = tiledTile(t, t->p, tx, Y/TILE);
+        e = tx+1 < t->tw ? tiledTile(t, t->p, tx+1, Y/TILE) : NULL;
+        ws[0][0][i] = ((c[Y%TILE] << MEMO_GENS) | (w ? w[Y%TILE] >> (TILE - MEMO_GENS) : 0)) & keep[0];
+        ws[0][1][i] = ((c[Y%TILE] >> (TILE - MEMO_GENS)) | (e ? e[Y%TILE] << MEMO_GENS : 0)) & keep[1];
+    }
+    return keep[0] == ~(uint64_t)0 && keep[1] == MEMO_SIDE && *top == 0 && *bottom == MEMO_ROWS;
+}
+static inline uint64_t memoHash(uint64_t (*ws)[TILE + 2*TILED_HALO]) {
+    uint64_t a = 0x9E3779B97F4A7C15ull, b = 0xC2B2AE3D27D4EB4Full;
+    int i;
+
+    //a lane per word of the strip, so the multiplies overlap
+    for (i = 0; i < MEMO_ROWS; ++i) {
+        a = (a ^ ws[0][i]) * 0xBF58476D1CE4E5B9ull;
+        b = (b ^ ws[1][i]) * 0x94D049BB133111EBull;
+    }
+    a ^= b + (a >> 29);
+    return a ^ (a >> 32);
+}
+//the tile's row y out of a strip
+static inline uint64_t memoRow(uint64_t (*ws)[TILE + 2*TILED_HALO], int y) {
+    return ws[0][MEMO_GENS + y] >> MEMO_GENS | ws[1][MEMO_GENS + y] << (TILE - MEMO_GENS);
+}
+//step a gathered strip MEMO_GENS generations, the tile from it into out;
+//returns whether the tile, src before, changed in any of them
+static inline int memoRun(uint64_t (*ws)[2][TILE + 2*TILED_HALO], const uint64_t* keep, int top, int bottom, const uint64_t* src, uint64_t* out) {
+    uint64_t aw, a, ae, bw, b, be, cw, c, ce;
+    int g, s, lo, hi, i, j, y, moved = 0;
+
+    //each generation the good part shrinks by a row, as in tiledStep
+    for (g = 0, s = 0; g < MEMO_GENS; ++g, s = !s) {
+        lo = g+1 > top ? g+1 : top;
+        hi = MEMO_ROWS-g-1 < bottom ? MEMO_ROWS-g-1 : bottom;
+        for (j = 0; j < 2; ++j) {
+            tiledWord(ws[s], 2, lo-1, j, &aw, &a, &ae);
+            tiledWord(ws[s], 2, lo, j, &bw, &b, &be);
+            for (i = lo; i < hi; ++i) {
+                tiledWord(ws[s], 2, i+1, j, &cw, &c, &ce);
+                ws[!s][j][i] = lifeWord(aw, a, ae, bw, b, be, cw, c, ce) & keep[j];
+                aw = bw; a = b; ae = be;
+                bw = cw; b = c; be = ce;
+            }
+        }
+        for (y = 0; !moved && y < TILE; ++y)
+            moved = memoRow(ws[!s], y) != src[y];
+    }
+    for (y = 0; y < TILE; ++y)
+        out[y] = memoRow(ws[s], y);
+    return moved;
+}
+
+//a strip wholly inside the universe, from the table or stepped into it
+static inline int memoLookup(struct memo_thread* th, const uint64_t* keep, const uint64_t* src, uint64_t* dst) {
+    struct memo_entry *e, *set;
+    uint64_t h, any = 0;
+    int i;
+
+    //nothing near stays nothing, and isn't worth a slot
+    for (i = 0; i < MEMO_ROWS; ++i)
+        any |= th->ws[0][0][i] | th->ws[0][1][i];
+    if (!any) {
+        memset(dst, 0, TILE_BYTES);
+        return 0;
+    }
+    h = memoHash(th->ws[0]) | 1;
+    set = &th->table[h & (th->slots-1) & ~(uint64_t)(MEMO_WAYS-1)];
+    for (i = 0; i < MEMO_WAYS; ++i) {
+        e = &set[i];
+        if (e->hash == h && !memcmp(e->key[0], th->ws[0][0], sizeof(e->key[0])) && !memcmp(e->key[1], th->ws[0][1], sizeof(e->key[1]))) {
+            memcpy(dst, e->out, TILE_BYTES);
+            ++th->hits;
+            return e->moved;
+        }
+    }
+    //an empty way, or one picked by the hash's top bits
+    for (i = 0, e = &set[h >> 62 & (MEMO_WAYS-1)]; i < MEMO_WAYS; ++i)
+        if (!set[i].hash)
+            e = &set[i];
+    //the strip is stepped in place, so take the key first
+    memcpy(e->key[0], th->ws[0][0], sizeof(e->key[0]));
+    memcpy(e->key[1], th->ws[0][1], sizeof(e->key[1]));
+    e->moved = memoRun(th->ws, keep, 0, MEMO_ROWS, src, dst);
+    memcpy(e->out, dst, TILE_BYTES);
+    e->hash = h;
+    ++th->misses;
+    return e->moved;
+}
+//step one active tile MEMO_GENS generations into the other plane
+static inline void memoTask(void* arg, uint32_t task, int thread) {
+    struct memo* m = arg;
+    struct tiled* t = m->t;
+    struct memo_thread* th = &m->thread[thread];
+    uint32_t id = t->active[task];
+    uint64_t tx = id % t->tw, ty = id / t->tw, keep[2];
+    const uint64_t* src = tiledTile(t, t->p, tx, ty);
+    uint64_t* dst = tiledTile(t, !t->p, tx, ty);
+    int top, bottom;
+
+    if (memoGather(t, tx, ty, th->ws, keep, &top, &bottom))
+        t->next[id] = (unsigned char)memoLookup(th, keep, src, dst);
+    else
+        t->next[id] = (unsigned char)memoRun(th->ws, keep, top, bottom, src, dst);
+    t->stale[id] |= t->next[id];
+}
+
+//advance steps times MEMO_GENS generations over the active tiles, on t->pool
+static inline void memoStep(struct memo* m, uint64_t steps) {
+    for (; steps > 0; --steps) {
+        poolRun(m->t->pool, tiledActive(m->t), memoTask, m);
+        tiledFlip(m->t);
+    }
+}
+
+//lookups so far, over every thread
+static inline void memoCount(struct memo* m, uint64_t* hits, uint64_t* misses) {
+    int i;
+
+    *hits = *misses = 0;
+    for (i = 0; i < m->threads; ++i) {
+        *hits += m->thread[i].hits;
+        *misses += m->thread[i].misses;
+    }
+}
+
+#endif
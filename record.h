@@ -0,0 +1,434 @@
+/*
+    Conway's Game of Life Replica - asynchronous frame export
+    Generations are snapshotted into a small pool of frame buffers and
+    encoded on background threads, so the simulation never waits on I/O:
+        *  .y4m   raw YUV4MPEG2, mono, one frame per generation
+        *  .gif   animated GIF, looping
+        *  .png   PNG sequence, x.png becomes x-<gen>.png
+    When every buffer is still queued the frame is dropped and counted
+    rather than stalling the caller, unless the caller asked to wait:
+    runs without a window have no frame deadline and want every frame.
+
+    One image pixel per cell, scaled up by an integer factor, coloured
+    like the SDL frontend. Link with -lpthread -lz.
+*/
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <zlib.h>
+
+#define REC_QUEUE 16        //frame buffers, queued or being encoded
+#define REC_THREADS 8       //most encoder threads
+enum { REC_Y4M, REC_PNG, REC_GIF };
+
+struct rec_frame
+{
+    uint64_t gen;
+    uint64_t seq;           //order frames are written in, drops don't leave gaps
+    unsigned char* px;      //palette index per cell, row-major
+};
+struct rec
+{
+    int kind;
+    int w, h;               //cells
+    int scale;              //image pixels per cell side
+    int fps;
+    char path[1024];
+    FILE* out;              //single file formats
+    int on;                 //frames are taken while on
+    int wait;               //block for a free buffer instead of dropping
+    //frames and the queue of filled ones, guarded by lock
+    struct rec_frame frame[REC_QUEUE];
+    int freeList[REC_QUEUE];
+    int nfree;
+    int queue[REC_QUEUE];
+    int qhead, qlen;
+    uint64_t seq;           //next seq handed out
+    uint64_t written;       //next seq allowed to write
+    unsigned long dropped;
+    int stop;
+    pthread_mutex_t lock;
+    pthread_cond_t ready;   //queue gained a frame, or stop
+    pthread_cond_t turn;    //written moved on, freeing a buffer
+    pthread_t thread[REC_THREADS];
+    int threads;
+};
+
+//palette: 0 DEAD, 1 LIVE, as drawn on screen
+static const unsigned char REC_RGB[2][3] = { { 0xCC, 0xCC, 0xCC }, { 0x30, 0x90, 0x00 } };
+static const unsigned char REC_LUMA[2] = { 0xCC, 0x6A };
+
+//growable output buffer, one per encoder thread
+struct rec_buf
+{
+    unsigned char* b;
+    size_t len, cap;
+};
+static inline void recPut(struct rec_buf* o, const void* p, size_t n) {
+    if (o->len + n > o->cap) {
+        o->cap = (o->len + n)*2;
+        o->b = realloc(o->b, o->cap);
+    }
+    memcpy(o->b + o->len, p, n);
+    o->len += n;
+}
+static inline void recByte(struct rec_buf* o, unsigned char c) {
+    recPut(o, &c, 1);
+}
+static inline void recBe32(struct rec_buf* o, uint32_t v) {
+    unsigned char b[4] = { v >> 24, v >> 16, v >> 8, v };
+    recPut(o, b, 4);
+}
+static inline void recLe16(struct rec_buf* o, unsigned v) {
+    unsigned char b[2] = { v & 0xFF, v >> 8 };
+    recPut(o, b, 2);
+}
+
+//png chunk: length, type, data, crc over type and data
+static inline void recPngChunk(struct rec_buf* o, const char* type, const unsigned char* data, uint32_t len) {
+    uLong crc = crc32(0, (const Bytef*)type, 4);
+    recBe32(o, len);
+    recPut(o, type, 4);
+    if (len) {
+        recPut(o, data, len);
+        crc = crc32(crc, data, len);
+    }
+    recBe32(o, crc);
+}
+static inline int recPng(struct rec* r, const unsigned char* px, struct rec_buf* o, struct rec_buf* tmp) {
+    static const unsigned char sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    int W = r->w*r->scale, H = r->h*r->scale;
+    unsigned char ihdr[13];
+    uLongf zlen;
+    size_t at;
+    int x, y;
+
+    //rows of filter byte 0 then indices, scaled
+    tmp->len = 0;
+    for (y = 0; y < H; ++y) {
+        recByte(tmp, 0);
+        for (x = 0; x < W; ++x)
+            recByte(tmp, px[(y/r->scale)*r->w + x/r->scale]);
+    }
+    o->len = 0;
+    recPut(o, sig, 8);
+    ihdr[0] = W >> 24; ihdr[1] = W >> 16; ihdr[2] = W >> 8; ihdr[3] = W;
+    ihdr[4] = H >> 24; ihdr[5] = H >> 16; ihdr[6] = H >> 8; ihdr[7] = H;
+    ihdr[8] = 8;        //bit depth
+    ihdr[9] = 3;        //palette
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;
+    recPngChunk(o, "IHDR", ihdr, 13);
+    recPngChunk(o, "PLTE", &REC_RGB[0][0], sizeof(REC_RGB));
+
+    //IDAT compressed straight into o after room for its length and type
+    zlen = compressBound(tmp->len);
+    if (o->len + 8 + zlen + 4 + 12 > o->cap) {
+        o->cap = o->len + 8 + zlen + 4 + 12;
+        o->b = realloc(o->b, o->cap);
+    }
+    at = o->len;
+    o->len += 8;
+    if (compress2(o->b + o->len, &zlen, tmp->b, tmp->len, Z_BEST_SPEED) != Z_OK)
+        return -1;
+    o->b[at] = zlen >> 24; o->b[at+1] = zlen >> 16; o->b[at+2] = zlen >> 8; o->b[at+3] = zlen;
+    memcpy(o->b + at + 4, "IDAT", 4);
+    o->len += zlen;
+    recBe32(o, crc32(0, o->b + at + 4, zlen + 4));
+    recPngChunk(o, "IEND", NULL, 0);
+    return 0;
+}
+
+//gif: one full image per frame, lzw with 2 bit roots
+static inline int recGif(struct rec* r, const unsigned char* px, struct rec_buf* o, struct rec_buf* tmp) {
+    static __thread short next[4096][4];
+    int W = r->w*r->scale, H = r->h*r->scale;
+    int clear = 4, eoi = 5, avail, size, code, k, x, y;
+    uint32_t acc = 0;
+    int bits = 0;
+    unsigned char block[256];
+    int nblock = 0;
+
+    o->len = 0;
+    //graphic control: delay in hundredths
+    recByte(o, 0x21); recByte(o, 0xF9); recByte(o, 4); recByte(o, 0);
+    recLe16(o, r->fps > 0 ? (100 + r->fps/2)/r->fps : 4);
+    recByte(o, 0); recByte(o, 0);
+    //image descriptor, no local palette
+    recByte(o, 0x2C);
+    recLe16(o, 0); recLe16(o, 0); recLe16(o, W); recLe16(o, H);
+    recByte(o, 0);
+    recByte(o, 2);
+
+    //emit a code into 255 byte sub-blocks
+#define REC_EMIT(c) do { \
+        acc |= (uint32_t)(c) << bits; \
+        bits += size; \
+        while (bits >= 8) { \
+            block[++nblock] = acc & 0xFF; \
+            acc >>= 8; \
+            bits -= 8; \
+            if (nblock == 255) { \
+                block[0] = 255; \
+                recPut(o, block, 256); \
+                nblock = 0; \
+            } \
+        } \
+    } while (0)
+
+    memset(next, 0, sizeof(next));
+    size = 3;
+    avail = eoi + 1;
+    REC_EMIT(clear);
+    code = -1;
+    for (y = 0; y < H; ++y) {
+        for (x = 0; x < W; ++x) {
+            k = px[(y/r->scale)*r->w + x/r->scale];
+            if (code < 0) {
+                code = k;
+                continue;
+            }
+            if (next[code][k]) {
+                code = next[code][k];
+                continue;
+            }
+            REC_EMIT(code);
+            if (avail < 4096) {
+                next[code][k] = avail;
+                if (avail == (1 << size) && size < 12)
+                    ++size;
+                ++avail;
+            }
+            else {
+                //table full, start over
+                REC_EMIT(clear);
+                memset(next, 0, sizeof(next));
+                size = 3;
+                avail = eoi + 1;
+            }
+            code = k;
+        }
+    }
+    if (code >= 0)
+        REC_EMIT(code);
+    REC_EMIT(eoi);
+    if (bits > 0) {
+        block[++nblock] = acc & 0xFF;
+        if (nblock == 255) {
+            block[0] = 255;
+            recPut(o, block, 256);
+            nblock = 0;
+        }
+    }
+    if (nblock) {
+        block[0] = nblock;
+        recPut(o, block, nblock + 1);
+    }
+    recByte(o, 0);
+#undef REC_EMIT
+    (void)tmp;
+    return 0;
+}
+
+static inline int recY4m(struct rec* r, const unsigned char* px, struct rec_buf* o, struct rec_buf* tmp) {
+    int W = r->w*r->scale, H = r->h*r->scale;
+    int x, y;
+
+    o->len = 0;
+    recPut(o, "FRAME\n", 6);
+    for (y = 0; y < H; ++y)
+        for (x = 0; x < W; ++x)
+            recByte(o, REC_LUMA[px[(y/r->scale)*r->w + x/r->scale]]);
+    (void)tmp;
+    return 0;
+}
+
+static inline void* recWorker(void* arg) {
+    struct rec* r = arg;
+    struct rec_buf o = { NULL, 0, 0 }, tmp = { NULL, 0, 0 };
+    struct rec_frame* f;
+    char name[1100];
+    FILE* png;
+    int i, ok;
+
+    pthread_mutex_lock(&r->lock);
+    while (1) {
+        while (!r->qlen && !r->stop)
+            pthread_cond_wait(&r->ready, &r->lock);
+        if (!r->qlen)
+            break;
+        i = r->queue[r->qhead];
+        r->qhead = (r->qhead + 1) % REC_QUEUE;
+        --r->qlen;
+        pthread_mutex_unlock(&r->lock);
+
+        //encode outside the lock
+        f = &r->frame[i];
+        if (r->kind == REC_PNG)
+            ok = recPng(r, f->px, &o, &tmp) == 0;
+        else if (r->kind == REC_GIF)
+            ok = recGif(r, f->px, &o, &tmp) == 0;
+        else
+            ok = recY4m(r, f->px, &o, &tmp) == 0;
+
+        if (r->kind == REC_PNG) {
+            //files stand alone, no ordering needed
+            snprintf(name, sizeof(name), "%.*s-%08llu.png", (int)strlen(r->path) - 4, r->path, (unsigned long long)f->gen);
+            if (ok && (png = fopen(name, "wb"))) {
+                fwrite(o.b, 1, o.len, png);
+                fclose(png);
+            }
+            else
+                fprintf(stderr, "gol: can't write %s\n", name);
+            pthread_mutex_lock(&r->lock);
+        }
+        else {
+            //one stream, so wait for our turn
+            pthread_mutex_lock(&r->lock);
+            while (r->written != f->seq)
+                pthread_cond_wait(&r->turn, &r->lock);
+            pthread_mutex_unlock(&r->lock);
+            if (ok)
+                fwrite(o.b, 1, o.len, r->out);
+            pthread_mutex_lock(&r->lock);
+        }
+        ++r->written;
+        pthread_cond_broadcast(&r->turn);
+        r->freeList[r->nfree++] = i;
+    }
+    pthread_mutex_unlock(&r->lock);
+    free(o.b);
+    free(tmp.b);
+    return NULL;
+}
+
+//start recording to path, kind picked from its extension; 0 on success
+static inline int rec_init(struct rec* r, const char* path, int w, int h, int scale, int fps) {
+    size_t n = strlen(path);
+    long cpus;
+    int i;
+
+    memset(r, 0, sizeof(*r));
+    if (n > 4 && !strcmp(path + n - 4, ".y4m"))
+        r->kind = REC_Y4M;
+    else if (n > 4 && !strcmp(path + n - 4, ".gif"))
+        r->kind = REC_GIF;
+    else if (n > 4 && !strcmp(path + n - 4, ".png"))
+        r->kind = REC_PNG;
+    else
+        return -1;
+    if (n >= sizeof(r->path) || scale < 1 || w*scale > 0xFFFF || h*scale > 0xFFFF)
+        return -1;
+    memcpy(r->path, path, n + 1);
+    r->w = w;
+    r->h = h;
+    r->scale = scale;
+    r->fps = fps;
+
+    if (r->kind != REC_PNG) {
+        r->out = fopen(path, "wb");
+        if (!r->out)
+            return -1;
+    }
+    if (r->kind == REC_Y4M)
+        fprintf(r->out, "YUV4MPEG2 W%i H%i F%i:1 Ip A1:1 Cmono\n", w*scale, h*scale, fps > 0 ? fps : 30);
+    else if (r->kind == REC_GIF) {
+        struct rec_buf o = { NULL, 0, 0 };
+        recPut(&o, "GIF89a", 6);
+        recLe16(&o, w*scale);
+        recLe16(&o, h*scale);
+        recByte(&o, 0x80);      //global palette of 2 entries
+        recByte(&o, 0);
+        recByte(&o, 0);
+        recPut(&o, REC_RGB, sizeof(REC_RGB));
+        //loop forever
+        recByte(&o, 0x21); recByte(&o, 0xFF); recByte(&o, 11);
+        recPut(&o, "NETSCAPE2.0", 11);
+        recByte(&o, 3); recByte(&o, 1); recLe16(&o, 0); recByte(&o, 0);
+        fwrite(o.b, 1, o.len, r->out);
+        free(o.b);
+    }
+
+    for (i = 0; i < REC_QUEUE; ++i) {
+        r->frame[i].px = malloc((size_t)w*h);
+        if (!r->frame[i].px) {
+            while (i--)
+                free(r->frame[i].px);
+            if (r->out)
+                fclose(r->out);
+            return -1;
+        }
+        r->freeList[r->nfree++] = i;
+    }
+    pthread_mutex_init(&r->lock, NULL);
+    pthread_cond_init(&r->ready, NULL);
+    pthread_cond_init(&r->turn, NULL);
+    cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    r->threads = cpus < 1 ? 1 : cpus > REC_THREADS ? REC_THREADS : cpus;
+    for (i = 0; i < r->threads; ++i)
+        pthread_create(&r->thread[i], NULL, recWorker, r);
+    r->on = 1;
+    return 0;
+}
+
+//snapshot a column-major grid; only blocks on the encoders when r->wait is set
+static inline void recPush(struct rec* r, uint64_t gen, const char* grid, char live) {
+    struct rec_frame* f;
+    int i, x, y;
+
+    if (!r->on)
+        return;
+    pthread_mutex_lock(&r->lock);
+    while (r->wait && !r->nfree)
+        pthread_cond_wait(&r->turn, &r->lock);
+    if (!r->nfree) {
+        ++r->dropped;
+        pthread_mutex_unlock(&r->lock);
+        return;
+    }
+    i = r->freeList[--r->nfree];
+    pthread_mutex_unlock(&r->lock);
+
+    f = &r->frame[i];
+    f->gen = gen;
+    for (x = 0; x < r->w; ++x)
+        for (y = 0; y < r->h; ++y)
+            f->px[y*r->w + x] = (grid[x*r->h + y] == live);
+
+    pthread_mutex_lock(&r->lock);
+    f->seq = r->seq++;
+    r->queue[(r->qhead + r->qlen) % REC_QUEUE] = i;
+    ++r->qlen;
+    pthread_cond_signal(&r->ready);
+    pthread_mutex_unlock(&r->lock);
+}
+
+//drain what's queued, finish the file
+static inline void rec_close(struct rec* r) {
+    int i;
+
+    pthread_mutex_lock(&r->lock);
+    r->stop = 1;
+    pthread_cond_broadcast(&r->ready);
+    pthread_mutex_unlock(&r->lock);
+    for (i = 0; i < r->threads; ++i)
+        pthread_join(r->thread[i], NULL);
+    if (r->kind == REC_GIF)
+        fputc(0x3B, r->out);
+    if (r->out)
+        fclose(r->out);
+    for (i = 0; i < REC_QUEUE; ++i)
+        free(r->frame[i].px);
+    pthread_mutex_destroy(&r->lock);
+    pthread_cond_destroy(&r->ready);
+    pthread_cond_destroy(&r->turn);
+    if (r->dropped)
+        fprintf(stderr, "gol: recorder dropped %lu of %llu frames\n", r->dropped, (unsigned long long)(r->seq + r->dropped));
+}
+
+#endif
@@ -0,0 +1,304 @@
+/*
+    Conway's Game of Life Replica - shared-memory frame ring
+    One process steps the universe and publishes every generation into a
+    POSIX shared-memory ring; any number of viewers map it read-only and
+    decode straight out of the mapping.
+
+    Layout: a ring_head, then `slots` slots of `slotSize` bytes each.
+    Generation g lives in slot g % slots. A slot holds either
+        *  RING_FULL   bit-packed universe, bit i is cell (i / h, i % h)
+        *  RING_DELTA  uint32 indices of cells that flipped since g-1
+    and a full frame is published at least every `keyframe` generations
+    so late or lagging viewers can resync.
+
+    Each slot is a seqlock: seq is odd while the writer is in it. Readers
+    check seq before and after decoding and drop torn frames.
+
+    Link with -lrt on older glibc.
+*/
+#ifndef RING_H
+#define RING_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define RING_MAGIC 0x4C6F4721u
+#define RING_VERSION 1
+#define RING_SLOTS 64
+enum { RING_FULL, RING_DELTA };
+
+struct ring_head
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t w, h;          //universe size in cells
+    uint32_t slots;         //frames held
+    uint32_t keyframe;      //full frame at least this often
+    uint64_t slotSize;      //bytes per slot, header included
+    uint64_t head;          //newest published generation + 1, 0 while empty
+};
+struct ring_slot
+{
+    uint64_t seq;           //odd while being written
+    uint64_t gen;
+    uint32_t kind;
+    uint32_t len;           //payload bytes
+};
+struct ring
+{
+    struct ring_head* head;
+    size_t size;            //bytes mapped
+    int owner;              //created it, unlinks on close
+    char name[64];
+    size_t words;           //Uint64 words in a full frame
+    //writer: this and the last published frame, and room for a delta
+    uint64_t* cur;
+    uint64_t* prev;
+    uint32_t* delta;
+    int havePrev;
+    //reader: next generation wanted once synced to a full frame
+    uint64_t next;
+    int synced;
+};
+
+static inline void ringName(struct ring* r, const char* name) {
+    //shm names want exactly one leading slash
+    snprintf(r->name, sizeof(r->name), "%s%s", name[0] == '/' ? "" : "/", name);
+}
+static inline struct ring_slot* ringSlot(struct ring* r, uint64_t gen) {
+    return (struct ring_slot*)((char*)r->head + sizeof(struct ring_head) + (gen % r->head->slots)*r->head->slotSize);
+}
+static inline void* ringPayload(struct ring_slot* s) {
+    return (char*)s + sizeof(struct ring_slot);
+}
+static inline int ring_create(struct ring* r, const char* name, int w, int h) {
+    struct ring_head hd;
+    int fd;
+
+    memset(r, 0, sizeof(*r));
+    ringName(r, name);
+    r->words = ((size_t)w*h + 63)/64;
+
+    memset(&hd, 0, sizeof(hd));
+    hd.magic = RING_MAGIC;
+    hd.version = RING_VERSION;
+    hd.w = w;
+    hd.h = h;
+    hd.slots = RING_SLOTS;
+    hd.keyframe = RING_SLOTS/2;
+    //a delta is only sent when smaller than a full frame, so that's the most a slot holds
+    hd.slotSize = sizeof(struct ring_slot) + r->words*8;
+    r->size = sizeof(struct ring_head) + hd.slots*hd.slotSize;
+
+    //never take over a ring someone may still be serving or reading; EEXIST says so
+    fd = shm_open(r->name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+        return -1;
+    r->owner = 1;
+    if (ftruncate(fd, r->size) != 0) {
+        close(fd);
+        shm_unlink(r->name);
+        return -1;
+    }
+    r->head = mmap(NULL, r->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (r->head == MAP_FAILED) {
+        shm_unlink(r->name);
+        return -1;
+    }
+    r->cur = malloc(r->words*8);
+    r->prev = malloc(r->words*8);
+    r->delta = malloc(r->words*8);
+    if (!r->cur || !r->prev || !r->delta) {
+        munmap(r->head, r->size);
+        shm_unlink(r->name);
+        return -1;
+    }
+    //magic last, so an attaching reader never sees a half-made header
+    hd.magic = 0;
+    memcpy(r->head, &hd, sizeof(hd));
+    __atomic_store_n(&r->head->magic, RING_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+static inline int ring_attach(struct ring* r, const char* name) {
+    struct ring_head hd;
+    struct stat st;
+    int fd;
+
+    memset(r, 0, sizeof(*r));
+    ringName(r, name);
+    fd = shm_open(r->name, O_RDONLY, 0);
+    if (fd < 0)
+        return -1;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(hd) || pread(fd, &hd, sizeof(hd), 0) != sizeof(hd)
+        || hd.magic != RING_MAGIC || hd.version != RING_VERSION
+        || (size_t)st.st_size < sizeof(hd) + (size_t)hd.slots*hd.slotSize) {
+        close(fd);
+        return -1;
+    }
+    r->size = sizeof(hd) + (size_t)hd.slots*hd.slotSize;
+    r->head = mmap(NULL, r->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (r->head == MAP_FAILED)
+        return -1;
+    r->words = ((size_t)hd.w*hd.h + 63)/64;
+    return 0;
+}
+static inline void ring_close(struct ring* r) {
+    if (r->head)
+        munmap(r->head, r->size);
+    if (r->owner)
+        shm_unlink(r->name);
+    free(r->cur);
+    free(r->prev);
+    free(r->delta);
+    memset(r, 0, sizeof(*r));
+}
+
+//writer: publish generation gen of a column-major grid, LIVE cells == live
+static inline void ringPublish(struct ring* r, uint64_t gen, const char* grid, char live) {
+    struct ring_slot* s = ringSlot(r, gen);
+    size_t cells = (size_t)r->head->w*r->head->h;
+    size_t i, n = 0, most = r->words*8/sizeof(uint32_t);
+    uint64_t* tmp;
+    uint64_t d, seq;
+    int full;
+
+    //pack
+    memset(r->cur, 0, r->words*8);
+    for (i = 0; i < cells; ++i)
+        if (grid[i] == live)
+            r->cur[i/64] |= (uint64_t)1 << (i%64);
+
+    //diff against last frame while it stays smaller than a full one
+    full = !r->havePrev || gen % r->head->keyframe == 0;
+    for (i = 0; !full && i < r->words; ++i) {
+        for (d = r->cur[i] ^ r->prev[i]; d; d &= d-1) {
+            if (n == most) {
+                full = 1;
+                break;
+            }
+            r->delta[n++] = i*64 + __builtin_ctzll(d);
+        }
+    }
+
+    seq = s->seq;
+    __atomic_store_n(&s->seq, seq+1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    s->gen = gen;
+    if (full) {
+        s->kind = RING_FULL;
+        s->len = r->words*8;
+        memcpy(ringPayload(s), r->cur, s->len);
+    }
+    else {
+        s->kind = RING_DELTA;
+        s->len = n*sizeof(uint32_t);
+        memcpy(ringPayload(s), r->delta, s->len);
+    }
+    __atomic_store_n(&s->seq, seq+2, __ATOMIC_RELEASE);
+    __atomic_store_n(&r->head->head, gen+1, __ATOMIC_RELEASE);
+
+    //this frame is what the next one diffs against
+    tmp = r->prev;
+    r->prev = r->cur;
+    r->cur = tmp;
+    r->havePrev = 1;
+}
+
+//reader: decode one slot into grid; 0 on success, -1 if torn or overwritten
+static inline int ringApply(struct ring* r, uint64_t gen, int kind, char* grid, char live, char dead) {
+    struct ring_slot* s = ringSlot(r, gen);
+    size_t cells = (size_t)r->head->w*r->head->h;
+    uint64_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+    size_t i, n;
+
+    if ((seq & 1) || s->gen != gen || (kind >= 0 && s->kind != (uint32_t)kind))
+        return -1;
+    if (s->kind == RING_FULL) {
+        const uint64_t* b = ringPayload(s);
+        for (i = 0; i < cells; ++i)
+            grid[i] = (b[i/64] >> (i%64) & 1) ? live : dead;
+    }
+    else {
+        const uint32_t* c = ringPayload(s);
+        //len may be torn; never read past the slot
+        n = s->len;
+        if (n > r->head->slotSize - sizeof(struct ring_slot))
+            n = r->head->slotSize - sizeof(struct ring_slot);
+        n /= sizeof(uint32_t);
+        for (i = 0; i < n; ++i) {
+            if (c[i] < cells)
+                grid[c[i]] = (grid[c[i]] == live) ? dead : live;
+        }
+    }
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&s->seq, __ATOMIC_RELAXED) == seq ? 0 : -1;
+}
+
+//reader: load the newest full frame still in the ring; 0 on success
+static inline int ringSync(struct ring* r, uint64_t head, char* grid, char live, char dead) {
+    uint64_t g, oldest = head > r->head->slots ? head - r->head->slots : 0;
+
+    r->synced = 0;
+    for (g = head; g-- > oldest; ) {
+        if (ringApply(r, g, RING_FULL, grid, live, dead) == 0) {
+            r->next = g+1;
+            r->synced = 1;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+//reader: bring grid up to the newest published generation
+//returns that generation, or -1 if nothing could be shown yet
+static inline long ringRead(struct ring* r, char* grid, char live, char dead) {
+    uint64_t head = __atomic_load_n(&r->head->head, __ATOMIC_ACQUIRE);
+
+    if (head == 0)
+        return -1;
+    while (1) {
+        //resync from the newest full frame still in the ring
+        if ((!r->synced || head - r->next >= r->head->slots) && ringSync(r, head, grid, live, dead) != 0)
+            return -1;
+        //then replay the deltas after it
+        while (r->next < head) {
+            if (ringApply(r, r->next, -1, grid, live, dead) != 0) {
+                r->synced = 0;
+                break;
+            }
+            ++r->next;
+        }
+        if (r->synced)
+            return r->next - 1;
+        head = __atomic_load_n(&r->head->head, __ATOMIC_ACQUIRE);
+    }
+}
+
+//reader: bring grid one generation forward, for readers that want every one
+//returns the generation now in grid, or -1 if there is no newer one yet; after
+//falling out of the ring it resyncs, skipping what was lost, and may repeat some
+static inline long ringStep(struct ring* r, char* grid, char live, char dead) {
+    uint64_t head = __atomic_load_n(&r->head->head, __ATOMIC_ACQUIRE);
+
+    if (head == 0)
+        return -1;
+    if (!r->synced || head - r->next >= r->head->slots)
+        return ringSync(r, head, grid, live, dead) == 0 ? (long)r->next - 1 : -1;
+    if (r->next >= head)
+        return -1;
+    if (ringApply(r, r->next, -1, grid, live, dead) != 0) {
+        r->synced = 0;
+        return -1;
+    }
+    return r->next++;
+}
+
+#endif
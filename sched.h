@@ -0,0 +1,210 @@
+/*
+    Conway's Game of Life Replica - work-stealing task pool
+    poolRun hands tasks 0..n-1 to a fixed set of threads, the caller
+    included. Each thread starts on its own contiguous run of tasks, a
+    deque it pops from the back; once that is empty it steals from the
+    front of the others'. Neighbouring tasks stay on one thread while
+    the load is even, and move wherever there are idle threads when not.
+    The threads are only started by the first poolRun, so a run that never
+    steps on the pool never has them.
+
+    A deque is its front and back packed in one word, so owner and
+    thieves both claim a task with a single compare-and-swap.
+
+    Link with -lpthread.
+*/
+#ifndef SCHED_H
+#define SCHED_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define POOL_THREADS 64     //most threads, the caller included
+
+struct pool_deque
+{
+    uint64_t range;         //front in the low half, back in the high half
+    char pad[64 - sizeof(uint64_t)];
+} __attribute__((aligned(64)));
+struct pool;
+struct pool_worker
+{
+    struct pool* pool;
+    int id;
+    unsigned long stolen;   //tasks taken from other deques
+};
+struct pool
+{
+    int threads;
+    struct pool_deque deque[POOL_THREADS];
+    struct pool_worker worker[POOL_THREADS];
+    pthread_t thread[POOL_THREADS];
+    //the job, published under lock with a new epoch
+    void (*fn)(void* arg, uint32_t task, int thread);
+    void* arg;
+    uint64_t epoch;
+    int busy;               //threads still on this epoch's job
+    int stop;
+    int started;            //workers running, from the first poolRun on
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    pthread_cond_t done;
+};
+
+//take a task from the back of our own deque, or the front of another's
+static inline int poolPop(struct pool_deque* d, uint32_t* task) {
+    uint64_t r = __atomic_load_n(&d->range, __ATOMIC_ACQUIRE);
+    uint32_t lo, hi;
+
+    do {
+        lo = (uint32_t)r;
+        hi = (uint32_t)(r >> 32);
+        if (lo >= hi)
+            return 0;
+    } while (!__atomic_compare_exchange_n(&d->range, &r, (uint64_t)(hi-1) << 32 | lo, 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    *task = hi-1;
+    return 1;
+}
+static inline int poolSteal(struct pool_deque* d, uint32_t* task) {
+    uint64_t r = __atomic_load_n(&d->range, __ATOMIC_ACQUIRE);
+    uint32_t lo, hi;
+
+    do {
+        lo = (uint32_t)r;
+        hi = (uint32_t)(r >> 32);
+        if (lo >= hi)
+            return 0;
+    } while (!__atomic_compare_exchange_n(&d->range, &r, (uint64_t)hi << 32 | (lo+1), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    *task = lo;
+    return 1;
+}
+
+//run every task of the current job as thread w
+static inline void poolDrain(struct pool_worker* w) {
+    struct pool* p = w->pool;
+    uint32_t task;
+    int i, v;
+
+    while (poolPop(&p->deque[w->id], &task))
+        p->fn(p->arg, task, w->id);
+    //nothing left here; go round the others until all are empty
+    for (i = 1; i < p->threads; ) {
+        v = (w->id + i) % p->threads;
+        if (poolSteal(&p->deque[v], &task)) {
+            ++w->stolen;
+            p->fn(p->arg, task, w->id);
+            while (poolPop(&p->deque[w->id], &task))
+                p->fn(p->arg, task, w->id);
+        }
+        else
+            ++i;
+    }
+}
+static inline void* poolWorker(void* arg) {
+    struct pool_worker* w = arg;
+    struct pool* p = w->pool;
+    uint64_t seen = 0;
+
+    pthread_mutex_lock(&p->lock);
+    while (1) {
+        while (p->epoch == seen && !p->stop)
+            pthread_cond_wait(&p->start, &p->lock);
+        if (p->stop)
+            break;
+        seen = p->epoch;
+        pthread_mutex_unlock(&p->lock);
+
+        poolDrain(w);
+
+        pthread_mutex_lock(&p->lock);
+        if (--p->busy == 0)
+            pthread_cond_signal(&p->done);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+//size the pool for threads, or one per online CPU when threads < 1; the
+//threads - 1 workers are started by the first poolRun
+static inline int pool_init(struct pool* p, int threads) {
+    long cpus;
+    int i;
+
+    memset(p, 0, sizeof(*p));
+    if (threads < 1) {
+        cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus < 1 ? 1 : (int)cpus;
+    }
+    p->threads = threads > POOL_THREADS ? POOL_THREADS : threads;
+    pthread_mutex_init(&p->lock, NULL);
+    pthread_cond_init(&p->start, NULL);
+    pthread_cond_init(&p->done, NULL);
+    for (i = 0; i < p->threads; ++i) {
+        p->worker[i].pool = p;
+        p->worker[i].id = i;
+    }
+    return 0;
+}
+static inline void poolStart(struct pool* p) {
+    int i;
+
+    //worker 0 is whoever calls poolRun
+    for (i = 1; i < p->threads; ++i) {
+        if (pthread_create(&p->thread[i], NULL, poolWorker, &p->worker[i]) != 0) {
+            p->threads = i;
+            break;
+        }
+    }
+    p->started = 1;
+}
+static inline void pool_close(struct pool* p) {
+    int i;
+
+    pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    pthread_cond_broadcast(&p->start);
+    pthread_mutex_unlock(&p->lock);
+    for (i = 1; p->started && i < p->threads; ++i)
+        pthread_join(p->thread[i], NULL);
+    pthread_mutex_destroy(&p->lock);
+    pthread_cond_destroy(&p->start);
+    pthread_cond_destroy(&p->done);
+}
+
+//fn(arg, task, thread) for every task below n; returns once all are done
+static inline void poolRun(struct pool* p, uint32_t n, void (*fn)(void*, uint32_t, int), void* arg) {
+    uint32_t lo, hi;
+    int i;
+
+    //a contiguous share each, so neighbouring tasks start on one thread
+    for (i = 0; i < p->threads; ++i) {
+        lo = (uint32_t)((uint64_t)n*i/p->threads);
+        hi = (uint32_t)((uint64_t)n*(i+1)/p->threads);
+        __atomic_store_n(&p->deque[i].range, (uint64_t)hi << 32 | lo, __ATOMIC_RELAXED);
+    }
+    p->fn = fn;
+    p->arg = arg;
+    if (p->threads == 1 || n < 2) {
+        poolDrain(&p->worker[0]);
+        return;
+    }
+    if (!p->started)
+        poolStart(p);
+    pthread_mutex_lock(&p->lock);
+    ++p->epoch;
+    p->busy = p->threads - 1;
+    pthread_cond_broadcast(&p->start);
+    pthread_mutex_unlock(&p->lock);
+
+    poolDrain(&p->worker[0]);
+
+    pthread_mutex_lock(&p->lock);
+    while (p->busy)
+        pthread_cond_wait(&p->done, &p->lock);
+    pthread_mutex_unlock(&p->lock);
+}
+
+#endif
@@ -0,0 +1,570 @@
+/*
+    Conway's Game of Life Replica - bit-packed tiles
+    The universe is cut into 64x64 cell tiles, each 64 Uint64 rows with
+    bit x of row y set when cell (x, y) of the tile is LIVE. A tile steps
+    a whole row of 64 cells per handful of word operations.
+
+    Tile files hold a universe too big for memory:
+        *  one page of header
+        *  two planes of tiles in row-major tile order, generation g in
+           plane g & 1, the other plane is where g+1 is written
+    and are stepped through mmap, a row of tiles at a time, so only
+    three rows of the source plane and one of the destination are hot.
+
+    In memory, a tiled universe can also be stepped several generations
+    per visit: a block of tiles plus a halo as wide as the generations
+    stepped is copied to a workspace small enough to stay in L1, stepped
+    there, and only the block's centre is written back. Each sweep then
+    moves k generations for one read and one write of the universe.
+
+    Given a task pool, a tiled universe is instead stepped a generation
+    at a time over only its active tiles: those that changed last
+    generation and their neighbours. A tile that stayed still with
+    still neighbours is the same in both planes, so it is skipped. The
+    active tiles are the pool's tasks, so threads follow the live
+    population rather than splitting the whole area into even bands.
+    Right after such a generation the other plane is the one before it,
+    so what changed can be read off the active tiles alone, in words of
+    64 cells, without scanning the universe or allocating anything; after
+    a one generation dense step it is read off every tile the same way.
+
+    Cells outside the universe are DEAD, as in the char grid.
+*/
+#ifndef TILES_H
+#define TILES_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sched.h"
+#include "arena.h"
+
+#define TILE 64
+#define TILE_BYTES (TILE*sizeof(uint64_t))
+#define TILEFILE_MAGIC 0x4C6F4754u
+#define TILEFILE_PAGE 4096
+#define TILE_SOUP_ONE 65536  //tilefileSoup density resolution, a random word per bit
+#define TILED_BLOCK 16      //tiles across a temporal block
+#define TILED_HALO 32       //most generations per visit
+#define TILED_DEPTH 4       //default generations per visit
+
+//next state of 64 cells from their 8 neighbour words; b is the cells themselves
+static inline uint64_t lifeWord(uint64_t aw, uint64_t a, uint64_t ae, uint64_t bw, uint64_t b, uint64_t be, uint64_t cw, uint64_t c, uint64_t ce) {
+    uint64_t u, s1, t1, s2, t2, s3, t3, o, k, p, q;
+
+    //count neighbours bit-sliced: ones o, twos p^k, fours and up q|(p&k)
+    u = aw ^ a;  s1 = u ^ ae;  t1 = (aw & a) | (u & ae);
+    u = cw ^ c;  s2 = u ^ ce;  t2 = (cw & c) | (u & ce);
+    s3 = bw ^ be;  t3 = bw & be;
+    u = s1 ^ s2;  o = u ^ s3;  k = (s1 & s2) | (u & s3);
+    u = t1 ^ t2;  p = u ^ t3;  q = (t1 & t2) | (u & t3);
+    //2 or 3 neighbours, and 3 or LIVE
+    return (p ^ k) & ~(q | (p & k)) & (o | b);
+}
+
+//row yy (-1 to 64) of the tile at the centre of n, with its west and east neighbours
+static inline void tileRow(const uint64_t* const* n, int yy, uint64_t* w, uint64_t* c, uint64_t* e) {
+    int band = yy < 0 ? 0 : yy < TILE ? 3 : 6;
+    int r = yy < 0 ? TILE-1 : yy < TILE ? yy : 0;
+    uint64_t l = n[band] ? n[band][r] : 0;
+    uint64_t m = n[band+1] ? n[band+1][r] : 0;
+    uint64_t x = n[band+2] ? n[band+2][r] : 0;
+
+    *c = m;
+    *w = (m << 1) | (l >> (TILE-1));    //bit i holds cell i-1
+    *e = (m >> 1) | (x << (TILE-1));    //bit i holds cell i+1
+}
+
+//step one tile; n is NW N NE W C E SW S SE, NULL outside the universe
+//only the first rows rows and the bits in mask are inside it
+static inline void tileStep(uint64_t* dst, const uint64_t* const* n, uint64_t mask, int rows) {
+    uint64_t aw, a, ae, bw, b, be, cw, c, ce;
+    int y;
+
+    tileRow(n, -1, &aw, &a, &ae);
+    tileRow(n, 0, &bw, &b, &be);
+    for (y = 0; y < TILE; ++y) {
+        tileRow(n, y+1, &cw, &c, &ce);
+        dst[y] = y < rows ? lifeWord(aw, a, ae, bw, b, be, cw, c, ce) & mask : 0;
+        aw = bw; a = b; ae = be;
+        bw = cw; b = c; be = ce;
+    }
+}
+
+struct tilefile_head
+{
+    uint32_t magic;
+    uint32_t tile;          //cells per tile side
+    uint64_t w, h;          //universe size in cells
+    uint64_t gen;           //generation in plane gen & 1
+};
+struct tilefile
+{
+    int fd;
+    struct tilefile_head* head;
+    unsigned char* plane[2];
+    size_t size;            //bytes mapped
+    size_t planeSize;
+    uint64_t tw, th;        //tiles across and down
+};
+
+static inline uint64_t* tilefileTile(struct tilefile* f, int p, uint64_t tx, uint64_t ty) {
+    return (uint64_t*)(f->plane[p] + (ty*f->tw + tx)*TILE_BYTES);
+}
+//madvise a span of a plane, widened to whole pages
+static inline void tilefileAdvise(struct tilefile* f, int p, uint64_t ty, uint64_t rows, int advice) {
+    uintptr_t lo, hi;
+
+    if (ty >= f->th)
+        return;
+    if (ty + rows > f->th)
+        rows = f->th - ty;
+    lo = (uintptr_t)tilefileTile(f, p, 0, ty) & ~(uintptr_t)(TILEFILE_PAGE-1);
+    hi = (uintptr_t)tilefileTile(f, p, 0, ty + rows);
+    madvise((void*)lo, hi - lo, advice);
+}
+
+//open path, creating a w x h universe when it doesn't exist and w, h > 0
+//returns 1 if created, 0 if opened, -1 on error
+static inline int tilefile_open(struct tilefile* f, const char* path, uint64_t w, uint64_t h) {
+    struct tilefile_head hd;
+    struct stat st;
+    int made = 0;
+
+    memset(f, 0, sizeof(*f));
+    f->fd = open(path, O_RDWR);
+    if (f->fd < 0 && w > 0 && h > 0) {
+        f->fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+        made = 1;
+    }
+    if (f->fd < 0)
+        return -1;
+
+    if (made) {
+        memset(&hd, 0, sizeof(hd));
+        hd.magic = TILEFILE_MAGIC;
+        hd.tile = TILE;
+        hd.w = w;
+        hd.h = h;
+    }
+    else if (pread(f->fd, &hd, sizeof(hd), 0) != sizeof(hd) || hd.magic != TILEFILE_MAGIC || hd.tile != TILE) {
+        close(f->fd);
+        return -1;
+    }
+    //the header is only trusted as far as the sizes it makes fit, and no
+    //more tiles than tiled_init takes
+    f->tw = hd.w/TILE + (hd.w%TILE != 0);
+    f->th = hd.h/TILE + (hd.h%TILE != 0);
+    if (!f->tw || !f->th || f->tw > UINT32_MAX/f->th
+        || __builtin_mul_overflow(f->tw*f->th, (uint64_t)TILE_BYTES, &f->planeSize)
+        || __builtin_add_overflow(f->planeSize, (size_t)TILEFILE_PAGE-1, &f->planeSize)
+        || __builtin_mul_overflow(f->planeSize & ~(size_t)(TILEFILE_PAGE-1), (size_t)2, &f->size)
+        || __builtin_add_overflow(f->size, (size_t)TILEFILE_PAGE, &f->size)) {
+        close(f->fd);
+        if (made)
+            unlink(path);
+        return -1;
+    }
+    f->planeSize &= ~(size_t)(TILEFILE_PAGE-1);
+
+    //new files are sparse, the empty universe costs no disk
+    if (made && ftruncate(f->fd, f->size) != 0) {
+        close(f->fd);
+        unlink(path);
+        return -1;
+    }
+    if (fstat(f->fd, &st) != 0 || (size_t)st.st_size < f->size) {
+        close(f->fd);
+        return -1;
+    }
+    f->head = mmap(NULL, f->size, PROT_READ | PROT_WRITE, MAP_SHARED, f->fd, 0);
+    if (f->head == MAP_FAILED) {
+        close(f->fd);
+        return -1;
+    }
+    if (made)
+        memcpy(f->head, &hd, sizeof(hd));
+    f->plane[0] = (unsigned char*)f->head + TILEFILE_PAGE;
+    f->plane[1] = f->plane[0] + f->planeSize;
+    //both planes are only ever swept front to back
+    madvise(f->plane[0], 2*f->planeSize, MADV_SEQUENTIAL);
+    return made;
+}
+static inline void tilefile_close(struct tilefile* f) {
+    if (f->head) {
+        msync(f->head, f->size, MS_SYNC);
+        munmap(f->head, f->size);
+    }
+    if (f->fd >= 0)
+        close(f->fd);
+    memset(f, 0, sizeof(*f));
+    f->fd = -1;
+}
+
+//which bits and rows of tile (tx, ty) are inside the universe
+static inline uint64_t tilefileMask(struct tilefile* f, uint64_t tx) {
+    uint64_t w = f->head->w - tx*TILE;
+    return w >= TILE ? ~(uint64_t)0 : ((uint64_t)1 << w) - 1;
+}
+static inline int tilefileRows(struct tilefile* f, uint64_t ty) {
+    uint64_t h = f->head->h - ty*TILE;
+    return h >= TILE ? TILE : (int)h;
+}
+
+//fill the current plane with cells LIVE at the given density
+static inline void tilefileSoup(struct tilefile* f, double density, uint64_t (*rng)(uint64_t*), uint64_t* seed) {
+    //density to 16 bits, then one random word per bit from the lowest set one: OR for a 1, AND for a 0
+    int k = (int)(density*TILE_SOUP_ONE + 0.5), b, y, rows;
+    uint64_t tx, ty, x, mask;
+    uint64_t* t;
+
+    for (ty = 0; ty < f->th; ++ty) {
+        rows = tilefileRows(f, ty);
+        for (tx = 0; tx < f->tw; ++tx) {
+            t = tilefileTile(f, f->head->gen & 1, tx, ty);
+            mask = tilefileMask(f, tx);
+            for (y = 0; y < TILE; ++y) {
+                if (k >= TILE_SOUP_ONE)
+                    x = ~(uint64_t)0;
+                else if (k == 0)
+                    x = 0;
+                else
+                    for (x = 0, b = __builtin_ctz(k); b < 16; ++b)
+                        x = (k >> b & 1) ? (x | rng(seed)) : (x & rng(seed));
+                t[y] = y < rows ? x & mask : 0;
+            }
+        }
+    }
+}
+
+//advance gens generations, streaming a row of tiles at a time
+static inline void tilefileStep(struct tilefile* f, uint64_t gens) {
+    const uint64_t* n[9];
+    uint64_t tx, ty, g;
+    int p, q, dx, dy, rows;
+    uint64_t mask;
+
+    for (g = 0; g < gens; ++g) {
+        p = f->head->gen & 1;
+        q = !p;
+        tilefileAdvise(f, p, 0, 2, MADV_WILLNEED);
+        for (ty = 0; ty < f->th; ++ty) {
+            //ask for the row after next before we need it, drop the one behind us
+            tilefileAdvise(f, p, ty+2, 1, MADV_WILLNEED);
+            tilefileAdvise(f, q, ty, 1, MADV_WILLNEED);
+            if (ty >= 2)
+                tilefileAdvise(f, p, ty-2, 1, MADV_DONTNEED);
+            rows = tilefileRows(f, ty);
+            for (tx = 0; tx < f->tw; ++tx) {
+                for (dy = -1; dy <= 1; ++dy)
+                    for (dx = -1; dx <= 1; ++dx)
+                        n[(dy+1)*3 + dx+1] = ((ty == 0 && dy < 0) || ty+dy >= f->th || (tx == 0 && dx < 0) || tx+dx >= f->tw)
+                                             ? NULL : tilefileTile(f, p, tx+dx, ty+dy);
+                if (tx+2 < f->tw)
+                    __builtin_prefetch(tilefileTile(f, p, tx+2, ty+1 < f->th ? ty+1 : ty));
+                mask = tilefileMask(f, tx);
+                tileStep(tilefileTile(f, q, tx, ty), n, mask, rows);
+            }
+        }
+        //flipping the generation flips the planes, nothing is copied
+        f->head->gen++;
+    }
+}
+
+static inline uint64_t tilefilePopulation(struct tilefile* f) {
+    uint64_t i, n = 0, words = f->tw*f->th*TILE;
+    const uint64_t* t = (const uint64_t*)f->plane[f->head->gen & 1];
+
+    for (i = 0; i < words; ++i)
+        n += __builtin_popcountll(t[i]);
+    return n;
+}
+
+struct tiled
+{
+    uint64_t w, h;          //universe size in cells
+    uint64_t tw, th;        //tiles across and down
+    uint64_t* plane[2];     //current is plane[p], the other is written
+    int p;
+    int k;                  //generations per visit, 1 to TILED_HALO
+    //active tile stepping, when pool is set
+    struct pool* pool;
+    unsigned char* changed; //per tile, changed last generation
+    unsigned char* next;    //per tile, changed this generation
+    uint32_t* active;       //tiles to step this generation, row-major
+    uint32_t nactive;
+    int fresh;              //planes differ anywhere; step every tile
+    //what a copy of the universe kept elsewhere is missing, for tiledStale
+    unsigned char* stale;   //per tile, changed since the copy was brought up to date
+    int staleAll;           //or everything may have
+    //tiledStep workspace, words are tile columns and rows universe rows
+    uint64_t (*ws)[TILED_BLOCK + 2][TILE + 2*TILED_HALO];
+};
+
+static inline uint64_t* tiledTile(struct tiled* t, int p, uint64_t tx, uint64_t ty) {
+    return t->plane[p] + (ty*t->tw + tx)*TILE;
+}
+static inline int tiled_init(struct tiled* t, uint64_t w, uint64_t h, struct arena* a) {
+    t->w = w;
+    t->h = h;
+    t->tw = (w + TILE-1)/TILE;
+    t->th = (h + TILE-1)/TILE;
+    t->p = 0;
+    t->k = TILED_DEPTH;
+    t->pool = NULL;
+    t->fresh = 1;
+    t->nactive = 0;
+    if (t->tw*t->th > UINT32_MAX)
+        return -1;
+    t->plane[0] = arenaAlloc(a, t->tw*t->th*TILE_BYTES);
+    t->plane[1] = arenaAlloc(a, t->tw*t->th*TILE_BYTES);
+    t->changed = arenaAlloc(a, t->tw*t->th);
+    t->next = arenaAlloc(a, t->tw*t->th);
+    t->active = arenaAlloc(a, t->tw*t->th*sizeof(uint32_t));
+    t->stale = arenaAlloc(a, t->tw*t->th);
+    t->staleAll = 1;
+    t->ws = arenaAlloc(a, 2*sizeof(*t->ws));
+    return (t->plane[0] && t->plane[1] && t->changed && t->next && t->active && t->stale && t->ws) ? 0 : -1;
+}
+//empty, to be loaded from the copy tiledStale keeps, which is then up to date
+static inline void tiledClear(struct tiled* t) {
+    memset(t->plane[t->p], 0, t->tw*t->th*TILE_BYTES);
+    memset(t->stale, 0, t->tw*t->th);
+    t->fresh = 1;
+    t->staleAll = 0;
+}
+static inline void tiledSet(struct tiled* t, uint64_t x, uint64_t y) {
+    tiledTile(t, t->p, x/TILE, y/TILE)[y%TILE] |= (uint64_t)1 << (x%TILE);
+}
+static inline int tiledGet(struct tiled* t, uint64_t x, uint64_t y) {
+    return tiledTile(t, t->p, x/TILE, y/TILE)[y%TILE] >> (x%TILE) & 1;
+}
+
+//word j of workspace row i, with its west and east neighbours; 0 off the edge
+static inline void tiledWord(uint64_t (*ws)[TILE + 2*TILED_HALO], int cols, int i, int j, uint64_t* w, uint64_t* c, uint64_t* e) {
+    uint64_t l = j > 0 ? ws[j-1][i] : 0;
+    uint64_t m = ws[j][i];
+    uint64_t r = j+1 < cols ? ws[j+1][i] : 0;
+
+    *c = m;
+    *w = (m << 1) | (l >> (TILE-1));
+    *e = (m >> 1) | (r << (TILE-1));
+}
+
+//advance gens generations, up to t->k of them per visit to each block
+static inline void tiledStep(struct tiled* t, uint64_t gens) {
+    //workspace words are tile columns bx*TILED_BLOCK-1.., rows universe rows ty*TILE-k..
+    uint64_t (*ws)[TILED_BLOCK + 2][TILE + 2*TILED_HALO] = t->ws;
+    uint64_t keep[TILED_BLOCK + 2];
+    uint64_t aw, a, ae, bw, b, be, cw, c, ce;
+    int64_t X, Y;
+    uint64_t tx, ty, bx;
+    int rows, top, bottom, lo, hi, cols = TILED_BLOCK + 2;
+    int i, j, g, n, s, k = t->k;
+
+    if (k < 1)
+        k = 1;
+    if (k > TILED_HALO)
+        k = TILED_HALO;
+    while (gens > 0) {
+        n = gens < (uint64_t)k ? (int)gens : k;
+        rows = TILE + 2*n;
+        for (ty = 0; ty < t->th; ++ty) {
+            //workspace rows inside the universe
+            top = ty == 0 ? n : 0;
+            bottom = (int)(t->h - ty*TILE) + n < rows ? (int)(t->h - ty*TILE) + n : rows;
+            for (bx = 0; bx < t->tw; bx += TILED_BLOCK) {
+                //gather block and halo; whatever is outside the universe is DEAD in both buffers
+                memset(ws, 0, 2*sizeof(*ws));
+                for (j = 0; j < cols; ++j) {
+                    X = (int64_t)(bx + j) - 1;
+                    if (X < 0 || (uint64_t)X >= t->tw)
+                        keep[j] = 0;
+                    else if (t->w - X*TILE >= TILE)
+                        keep[j] = ~(uint64_t)0;
+                    else
+                        keep[j] = ((uint64_t)1 << (t->w - X*TILE)) - 1;
+                    for (i = top; keep[j] && i < bottom; ++i) {
+                        Y = (int64_t)(ty*TILE) - n + i;
+                        ws[0][j][i] = tiledTile(t, t->p, X, Y/TILE)[Y%TILE];
+                    }
+                }
+                //step it; each generation the good part shrinks by a row, so skip the rest
+                for (g = 0, s = 0; g < n; ++g, s = !s) {
+                    lo = g+1 > top ? g+1 : top;
+                    hi = rows-g-1 < bottom ? rows-g-1 : bottom;
+                    for (j = 0; j < cols; ++j) {
+                        if (!keep[j])
+                            continue;
+                        //roll three rows down the column, as tileStep does
+                        tiledWord(ws[s], cols, lo-1, j, &aw, &a, &ae);
+                        tiledWord(ws[s], cols, lo, j, &bw, &b, &be);
+                        for (i = lo; i < hi; ++i) {
+                            tiledWord(ws[s], cols, i+1, j, &cw, &c, &ce);
+                            ws[!s][j][i] = lifeWord(aw, a, ae, bw, b, be, cw, c, ce) & keep[j];
+                            aw = bw; a = b; ae = be;
+                            bw = cw; b = c; be = ce;
+                        }
+                    }
+                }
+                //write back the centre
+                for (j = 1; j <= TILED_BLOCK && (tx = bx + j - 1) < t->tw; ++j)
+                    memcpy(tiledTile(t, !t->p, tx, ty), &ws[s][j][n], TILE_BYTES);
+            }
+        }
+        t->p = !t->p;
+        gens -= n;
+    }
+    //both planes were rewritten, the active tiles are unknown
+    t->fresh = 1;
+    t->staleAll = 1;
+}
+
+//step one active tile into the other plane
+static inline void tiledTask(void* arg, uint32_t task, int thread) {
+    struct tiled* t = arg;
+    uint32_t id = t->active[task];
+    uint64_t tx = id % t->tw, ty = id / t->tw, w, h;
+    const uint64_t* n[9];
+    uint64_t* dst = tiledTile(t, !t->p, tx, ty);
+    int dx, dy;
+
+    (void)thread;
+    for (dy = -1; dy <= 1; ++dy)
+        for (dx = -1; dx <= 1; ++dx)
+            n[(dy+1)*3 + dx+1] = (tx+dx < t->tw && ty+dy < t->th) ? tiledTile(t, t->p, tx+dx, ty+dy) : NULL;
+    w = t->w - tx*TILE;
+    h = t->h - ty*TILE;
+    tileStep(dst, n, w >= TILE ? ~(uint64_t)0 : ((uint64_t)1 << w) - 1, h >= TILE ? TILE : (int)h);
+    t->next[id] = memcmp(dst, n[4], TILE_BYTES) != 0;
+    t->stale[id] |= t->next[id];
+}
+
+//gather the tiles next to one changed in the last step, or all of them after
+//a load or a dense step, into active; returns how many
+static inline uint32_t tiledActive(struct tiled* t) {
+    uint64_t tiles = t->tw*t->th, i, word;
+    uint64_t tx, ty, x0, x1, y0, y1, x, y;
+    uint32_t n;
+
+    //mark the neighbourhood of every changed tile in next, clearing changed as we go
+    if (t->fresh) {
+        memset(t->changed, 0, tiles);
+        memset(t->next, 1, tiles);
+    }
+    else {
+        for (i = 0; i < tiles; ++i) {
+            //whole words of still tiles at a time
+            if (i % 8 == 0 && i + 8 <= tiles) {
+                memcpy(&word, t->changed + i, 8);
+                if (!word) {
+                    i += 7;
+                    continue;
+                }
+            }
+            if (!t->changed[i])
+                continue;
+            t->changed[i] = 0;
+            tx = i % t->tw;
+            ty = i / t->tw;
+            x0 = tx ? tx-1 : 0;
+            x1 = tx+1 < t->tw ? tx+1 : tx;
+            y0 = ty ? ty-1 : 0;
+            y1 = ty+1 < t->th ? ty+1 : ty;
+            for (y = y0; y <= y1; ++y)
+                for (x = x0; x <= x1; ++x)
+                    t->next[y*t->tw + x] = 1;
+        }
+    }
+    //gather them in order, leaving next clear for the tasks
+    for (i = 0, n = 0; i < tiles; ++i) {
+        if (i % 8 == 0 && i + 8 <= tiles) {
+            memcpy(&word, t->next + i, 8);
+            if (!word) {
+                i += 7;
+                continue;
+            }
+        }
+        if (t->next[i]) {
+            t->next[i] = 0;
+            t->active[n++] = (uint32_t)i;
+        }
+    }
+    t->fresh = 0;
+    t->nactive = n;
+    return n;
+}
+
+//after the active tiles were stepped into the other plane, make it current
+static inline void tiledFlip(struct tiled* t) {
+    unsigned char* tmp;
+
+    t->p = !t->p;
+    //changed is all clear, next holds this generation's changes
+    tmp = t->changed;
+    t->changed = t->next;
+    t->next = tmp;
+}
+
+//advance gens generations over the active tiles only, on t->pool
+static inline void tiledStepActive(struct tiled* t, uint64_t gens) {
+    for (; gens > 0; --gens) {
+        poolRun(t->pool, tiledActive(t), tiledTask, t);
+        tiledFlip(t);
+    }
+}
+
+//fn(arg, tx, ty) for every tile changed since the last call, or all of them
+//after a load or a dense step; the copy fn keeps is then up to date
+static inline void tiledStale(struct tiled* t, void (*fn)(void*, uint64_t, uint64_t), void* arg) {
+    uint64_t tiles = t->tw*t->th, i, word;
+
+    for (i = 0; i < tiles; ++i) {
+        if (!t->staleAll) {
+            //whole words of still tiles at a time
+            if (i % 8 == 0 && i + 8 <= tiles) {
+                memcpy(&word, t->stale + i, 8);
+                if (!word) {
+                    i += 7;
+                    continue;
+                }
+            }
+            if (!t->stale[i])
+                continue;
+        }
+        fn(arg, i % t->tw, i / t->tw);
+    }
+    memset(t->stale, 0, tiles);
+    t->staleAll = 0;
+}
+
+//words of 64 cells that changed in the generation tiledStepActive or a one
+//generation tiledStep just made: fn(arg, x, y, born, died) where bit i is cell
+//(x+i, y); no other order is promised
+static inline void tiledChanges(struct tiled* t, void (*fn)(void*, uint64_t, uint64_t, uint64_t, uint64_t), void* arg) {
+    const uint64_t *now, *was;
+    uint64_t tx, ty, d, i, id, n;
+    int y;
+
+    //after a dense step any tile may have changed, otherwise only active ones
+    n = t->fresh ? t->tw*t->th : t->nactive;
+    for (i = 0; i < n; ++i) {
+        id = t->fresh ? i : t->active[i];
+        tx = id % t->tw;
+        ty = id / t->tw;
+        now = tiledTile(t, t->p, tx, ty);
+        was = tiledTile(t, !t->p, tx, ty);
+        for (y = 0; y < TILE; ++y) {
+            d = now[y] ^ was[y];
+            if (d)
+                fn(arg, tx*TILE, ty*TILE + y, d & now[y], d & was[y]);
+        }
+    }
+}
+
+#endif